@@ -0,0 +1,102 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <reproc++/drain.hpp>
+#include <reproc++/reproc.hpp>
+
+static int fail(std::error_code ec)
+{
+  std::cerr << ec.message();
+  return ec.value();
+}
+
+// Uses the sink combinators from `drain.hpp` to process the output of the given
+// command in a single pass over the output.
+//
+// Example: "./sinks cmake --help" prints the first line of CMake's help output
+// together with some statistics about the output.
+int main(int argc, const char **argv)
+{
+  if (argc <= 1) {
+    std::cerr << "No arguments provided. Example usage: "
+              << "./sinks cmake --help";
+    return EXIT_FAILURE;
+  }
+
+  reproc::process process;
+
+  reproc::options options;
+  options.redirect.err.type = reproc::redirect::pipe;
+
+  std::error_code ec = process.start(argv + 1, options);
+  if (ec == std::errc::no_such_file_or_directory) {
+    std::cerr << "Program not found. Make sure it's available from the PATH.";
+    return ec.value();
+  } else if (ec) {
+    return fail(ec);
+  }
+
+  // Keep the first 80 bytes of output.
+  std::string head;
+  auto limited = reproc::sink::limit(80, reproc::sink::string(head));
+
+  // Forward stderr to our own stderr.
+  auto errors = reproc::sink::filter(
+      [](reproc::stream stream, const uint8_t *, size_t) {
+        return stream == reproc::stream::err;
+      },
+      reproc::sink::ostream(std::cerr));
+
+  // Count every chunk of output and every other chunk of output.
+  size_t chunks = 0;
+  size_t sampled = 0;
+
+  auto count = [](size_t &counter) {
+    return [&counter](reproc::stream, const uint8_t *, size_t size) {
+      counter += size > 0 ? 1 : 0;
+      return std::error_code();
+    };
+  };
+
+  auto every = reproc::sink::sample(2, count(sampled));
+
+  // Record when the first and last output was read.
+  std::chrono::nanoseconds first(0);
+  std::chrono::nanoseconds last(0);
+
+  auto timed = reproc::sink::timed(
+      [&first, &last](reproc::stream, const uint8_t *, size_t size,
+                      std::chrono::nanoseconds timestamp) {
+        if (size > 0) {
+          first = first.count() == 0 ? timestamp : first;
+          last = timestamp;
+        }
+
+        return std::error_code();
+      });
+
+  // `tee` stores the sinks by value. Both `out` and `err` receive the same tee
+  // so all sinks see the output of both streams.
+  auto sink = reproc::sink::tee(limited, errors, count(chunks), every, timed);
+
+  ec = reproc::drain(process, sink, sink);
+  if (ec) {
+    return fail(ec);
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(last -
+                                                                       first);
+
+  std::cout << head.substr(0, head.find('\n')) << std::endl
+            << chunks << " chunks (" << sampled << " sampled) over "
+            << elapsed.count() << "us" << std::endl;
+
+  int status = 0;
+  std::tie(status, ec) = process.wait(reproc::infinite);
+  if (ec) {
+    return fail(ec);
+  }
+
+  return status;
+}
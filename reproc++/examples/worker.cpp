@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <reproc++/pool.hpp>
+#include <reproc++/worker.hpp>
+
+#if !defined(_WIN32)
+  #include <csignal>
+#endif
+
+static int fail(const std::string &what, std::error_code ec)
+{
+  std::cerr << what << ": " << ec.message() << std::endl;
+  return EXIT_FAILURE;
+}
+
+static const uint8_t *bytes(const std::string &string)
+{
+  return reinterpret_cast<const uint8_t *>(string.data());
+}
+
+// Submits `requests` to `pool` and returns their results in request order.
+static std::vector<reproc::pool::result>
+run(reproc::pool &pool, const std::vector<std::string> &requests)
+{
+  std::vector<reproc::pool::result> results;
+
+  for (const std::string &request : requests) {
+    uint64_t ticket = 0;
+    std::error_code ec;
+    std::tie(ticket, ec) = pool.submit(bytes(request), request.size());
+    if (ec) {
+      results.push_back({ 0, std::string(), ec });
+      return results;
+    }
+  }
+
+  while (pool.pending() > 0) {
+    results.push_back(pool.receive());
+  }
+
+  std::sort(results.begin(), results.end(),
+            [](const reproc::pool::result &left,
+               const reproc::pool::result &right) {
+              return left.ticket < right.ticket;
+            });
+
+  return results;
+}
+
+static void print(const std::string &name,
+                  const std::vector<std::string> &requests,
+                  const std::vector<reproc::pool::result> &results)
+{
+  for (size_t i = 0; i < results.size(); i++) {
+    std::cout << name << ": " << requests[i] << " -> "
+              << (results[i].error ? results[i].error.message()
+                                   : results[i].response)
+              << std::endl;
+  }
+}
+
+// The worker example keeps an echo process alive across requests with
+// `reproc::worker` and spreads requests over several echo processes with
+// `reproc::pool`. Requests and responses are separated by newlines. The echo
+// process exits without answering when it receives "crash", after which a
+// request made once the restart backoff has passed restarts it. It answers
+// "pid" with its process ID which shows when the pool recycled a worker,
+// allocates memory on "grow" and never answers "hang".
+int main()
+{
+#if !defined(_WIN32)
+  // Writing to a worker that crashed raises `SIGPIPE`. Ignoring it makes the
+  // write fail with `std::errc::broken_pipe` instead.
+  signal(SIGPIPE, SIG_IGN);
+#endif
+
+  const char *argv[] = { RESOURCE_DIRECTORY "/worker", nullptr };
+
+  reproc::worker_options worker_options;
+  worker_options.framing = reproc::framing::delimiter;
+  worker_options.restart.backoff = reproc::milliseconds(10);
+
+  reproc::worker worker(argv, {}, worker_options);
+
+  for (std::string request : { "hello", "crash", "again" }) {
+    std::string response;
+    std::error_code ec;
+    std::tie(response, ec) = worker.call(bytes(request), request.size());
+
+    // `call` doesn't block while the worker is backing off after a crash so we
+    // wait ourselves and try again.
+    while (ec == std::errc::resource_unavailable_try_again) {
+      std::this_thread::sleep_for(worker.retry_after());
+      std::tie(response, ec) = worker.call(bytes(request), request.size());
+    }
+
+    // The crash fails the request in flight. The worker is restarted by the
+    // call that follows it once the backoff has passed.
+    if (request == "crash") {
+      if (ec != std::errc::broken_pipe) {
+        return fail("crash", ec);
+      }
+
+      std::cout << "worker: " << request << " -> " << ec.message() << std::endl;
+      continue;
+    }
+
+    if (ec) {
+      return fail(request, ec);
+    }
+
+    if (response != request) {
+      std::cerr << "Unexpected response: " << response << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "worker: " << request << " -> " << response << std::endl;
+  }
+
+  reproc::pool_options pool_options;
+  pool_options.size = 2;
+
+  reproc::pool pool(argv, {}, worker_options, pool_options);
+
+  for (std::string request : { "one", "crash", "two", "three", "four" }) {
+    uint64_t ticket = 0;
+    std::error_code ec;
+    std::tie(ticket, ec) = pool.submit(bytes(request), request.size());
+    if (ec) {
+      return fail(request, ec);
+    }
+  }
+
+  // Responses arrive in completion order and are matched to their requests by
+  // the ticket returned from `submit`.
+  size_t answered = 0;
+
+  while (pool.pending() > 0) {
+    reproc::pool::result result = pool.receive();
+    if (result.error && result.error != std::errc::broken_pipe) {
+      return fail("receive", result.error);
+    }
+
+    std::cout << "pool: #" << result.ticket << " -> "
+              << (result.error ? result.error.message() : result.response)
+              << std::endl;
+
+    if (!result.error) {
+      answered++;
+    }
+  }
+
+  // Every request except the crash is answered, including the ones handled
+  // by the worker that was restarted after crashing.
+  if (answered != 4) {
+    std::cerr << "Expected 4 responses, got " << answered << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The only worker crashes so the next request has to wait until the worker
+  // can be restarted.
+  pool_options = reproc::pool_options();
+  pool_options.size = 1;
+
+  std::vector<std::string> requests = { "crash", "after" };
+  std::vector<reproc::pool::result> results;
+
+  {
+    reproc::pool crashed(argv, {}, worker_options, pool_options);
+    results = run(crashed, requests);
+  }
+
+  print("backoff", requests, results);
+
+  if (results.size() != 2 || results[0].error != std::errc::broken_pipe ||
+      results[1].error || results[1].response != "after") {
+    std::cerr << "Expected the worker to be restarted after crashing"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A single worker that's recycled after every two requests.
+  pool_options = reproc::pool_options();
+  pool_options.size = 1;
+  pool_options.recycle.requests = 2;
+
+  requests = { "pid", "pid", "pid", "pid" };
+
+  {
+    reproc::pool recycled(argv, {}, worker_options, pool_options);
+    results = run(recycled, requests);
+  }
+
+  print("requests", requests, results);
+
+  if (results.size() != 4 || results[0].error || results[2].error ||
+      results[0].response != results[1].response ||
+      results[1].response == results[2].response ||
+      results[2].response != results[3].response) {
+    std::cerr << "Expected the worker to be recycled after 2 requests"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+#if defined(__linux__)
+  // A single worker that's recycled once it uses more than 32MB.
+  pool_options = reproc::pool_options();
+  pool_options.size = 1;
+  pool_options.recycle.rss = 32 * 1024 * 1024;
+
+  requests = { "pid", "grow", "pid" };
+
+  {
+    reproc::pool recycled(argv, {}, worker_options, pool_options);
+    results = run(recycled, requests);
+  }
+
+  print("rss", requests, results);
+
+  if (results.size() != 3 || results[0].error || results[1].error ||
+      results[2].error || results[0].response == results[2].response) {
+    std::cerr << "Expected the worker to be recycled after growing"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+#endif
+
+  // A request that isn't answered in time fails with `std::errc::timed_out`.
+  // The worker handling it is restarted so the next request is answered again.
+  pool_options = reproc::pool_options();
+  pool_options.size = 1;
+  pool_options.timeout = reproc::milliseconds(200);
+
+  requests = { "hang", "after" };
+
+  {
+    reproc::pool timed(argv, {}, worker_options, pool_options);
+    results = run(timed, requests);
+  }
+
+  print("timeout", requests, results);
+
+  if (results.size() != 2 || results[0].error != std::errc::timed_out ||
+      results[1].error || results[1].response != "after") {
+    std::cerr << "Expected the hanging request to time out" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
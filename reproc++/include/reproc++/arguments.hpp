@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include <reproc++/detail/array.hpp>
 #include <reproc++/detail/type_traits.hpp>
 
@@ -8,13 +10,14 @@ namespace reproc {
 class arguments : public detail::array {
 public:
   arguments(const char *const *argv) // NOLINT
-      : detail::array(argv, false)
+      : detail::array(argv)
   {}
 
   /*!
   `Arguments` must be iterable as a sequence of strings. Examples of types that
-  satisfy this requirement are `std::vector<std::string>` and
-  `std::array<std::string>`.
+  satisfy this requirement are `std::vector<std::string>`,
+  `std::array<std::string>` and `std::vector<std::string_view>`. Each string
+  must provide `data()` and `size()`.
 
   `arguments` has the same restrictions as `argv` in `reproc_start` except
   that it should not end with `NULL` (`start` allocates a new array which
@@ -23,37 +26,38 @@ public:
   template <typename Arguments,
             typename = detail::enable_if_not_char_array<Arguments>>
   arguments(const Arguments &arguments) // NOLINT
-      : detail::array(from(arguments), true)
-  {}
+  {
+    from(arguments);
+  }
 
 private:
   template <typename Arguments>
-  static const char *const *from(const Arguments &arguments);
+  void from(const Arguments &arguments);
 };
 
 template <typename Arguments>
-const char *const *arguments::from(const Arguments &arguments)
+void arguments::from(const Arguments &arguments)
 {
-  using size_type = typename Arguments::value_type::size_type;
+  std::size_t count = 0;
+  std::size_t size = 0;
+
+  for (const auto &argument : arguments) {
+    count++;
+    size += argument.size() + 1; // Count the NUL terminator.
+  }
 
-  const char **argv = new const char *[arguments.size() + 1];
+  const char **argv = allocate(count, size);
+  char *string = reinterpret_cast<char *>(argv + count + 1);
   std::size_t current = 0;
 
   for (const auto &argument : arguments) {
-    char *string = new char[argument.size() + 1];
-
     argv[current++] = string;
-
-    for (size_type i = 0; i < argument.size(); i++) {
-      *string++ = argument[i];
-    }
-
-    *string = '\0';
+    string = std::copy(argument.data(), argument.data() + argument.size(),
+                       string);
+    *string++ = '\0';
   }
 
   argv[current] = nullptr;
-
-  return argv;
 }
 
 }
@@ -1,32 +1,39 @@
 #pragma once
 
 #include <cstddef>
+#include <utility>
 
 namespace reproc {
 namespace detail {
 
+/*! A `NULL` terminated array of strings that is either borrowed from the user
+or owned. Owned arrays store the pointers followed by the strings they point to
+in a single block of memory. The block is always allocated on the heap so
+`data()` stays valid when the array is moved, which `options::clone` relies on.
+*/
 class array {
-  const char *const *data_;
-  bool owned_;
+  const char *const *data_ = nullptr;
+  char *heap_ = nullptr;
 
 public:
-  array(const char *const *data, bool owned) noexcept
-      : data_(data), owned_(owned)
-  {}
+  array(const char *const *data) noexcept : data_(data) {} // NOLINT
 
-  array(array &&other) noexcept : data_(other.data_), owned_(other.owned_)
+  array(array &&other) noexcept : data_(other.data_), heap_(other.heap_)
   {
     other.data_ = nullptr;
-    other.owned_ = false;
+    other.heap_ = nullptr;
   }
 
   array &operator=(array &&other) noexcept
   {
     if (&other != this) {
+      delete[] heap_;
+
       data_ = other.data_;
-      owned_ = other.owned_;
+      heap_ = other.heap_;
+
       other.data_ = nullptr;
-      other.owned_ = false;
+      other.heap_ = nullptr;
     }
 
     return *this;
@@ -34,19 +41,30 @@ public:
 
   ~array() noexcept
   {
-    if (owned_) {
-      for (size_t i = 0; data_[i] != nullptr; i++) {
-        delete[] data_[i];
-      }
-
-      delete[] data_;
-    }
+    delete[] heap_;
   }
 
   const char *const *data() const noexcept
   {
     return data_;
   }
+
+protected:
+  array() noexcept = default;
+
+  /*! Makes this array own a block of memory with space for `count` pointers, a
+  `NULL` terminator and `size` bytes of string data which starts right after the
+  terminator. Returns the pointer array. */
+  const char **allocate(size_t count, size_t size)
+  {
+    delete[] heap_;
+    heap_ = new char[(count + 1) * sizeof(const char *) + size];
+
+    auto **pointers = reinterpret_cast<const char **>(heap_);
+    data_ = pointers;
+
+    return pointers;
+  }
 };
 
 }
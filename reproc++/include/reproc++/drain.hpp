@@ -1,23 +1,68 @@
 #pragma once
 
+#include <algorithm>
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <reproc++/reproc.hpp>
 
 namespace reproc {
 
+namespace source {
+
+/*! Leaves stdin alone. Passing `none` to `communicate` is equivalent to calling
+`drain`. */
+class none {
+public:
+  std::error_code
+  operator()(uint8_t *buffer, size_t size, size_t &produced) const noexcept
+  {
+    (void) buffer;
+    (void) size;
+    produced = 0;
+
+    return {};
+  }
+};
+
+/*! Writes `string` to stdin. `string` must outlive the source. */
+class string {
+  const std::string &string_;
+  size_t offset_ = 0;
+
+public:
+  explicit string(const std::string &string) noexcept : string_(string) {}
+
+  std::error_code operator()(uint8_t *buffer, size_t size, size_t &produced)
+  {
+    produced = std::min(size, string_.size() - offset_);
+    std::copy_n(string_.data() + offset_, produced, buffer);
+    offset_ += produced;
+
+    return {};
+  }
+};
+
+}
+
 /*!
-`reproc_drain` but takes lambdas as sinks. Return an error code from a sink to
-break out of `drain` early. `out` and `err` expect the following signature:
+`reproc_communicate` but takes lambdas as source and sinks. Return an error
+code from the source or a sink to break out of `communicate` early. `in`
+expects the following signature:
 
 ```c++
-std::error_code sink(stream stream, const uint8_t *buffer, size_t size);
+std::error_code source(uint8_t *buffer, size_t size, size_t &produced);
 ```
+
+`out` and `err` expect the signature described in `drain`.
 */
-template <typename Out, typename Err>
-std::error_code drain(process &process, Out &&out, Err &&err)
+template <typename In, typename Out, typename Err>
+std::error_code communicate(process &process, In &&in, Out &&out, Err &&err)
 {
   static constexpr uint8_t initial = 0;
   std::error_code ec;
@@ -36,12 +81,23 @@ std::error_code drain(process &process, Out &&out, Err &&err)
     return ec;
   }
 
-  static constexpr size_t BUFFER_SIZE = 4096;
-  uint8_t buffer[BUFFER_SIZE] = {};
+  static constexpr size_t BUFFER_SIZE = 65536;
+  // See `reproc_communicate`.
+  static constexpr size_t WRITE_SIZE = 4096;
+
+  bool writing =
+      !std::is_same<typename std::decay<In>::type, source::none>::value;
+
+  std::vector<uint8_t> buffer(BUFFER_SIZE);
+  std::vector<uint8_t> input(writing ? BUFFER_SIZE : 0);
+  size_t offset = 0;
+  size_t size = 0;
+  size_t turn = 0;
 
   for (;;) {
+    int interests = event::out | event::err | (writing ? event::in : 0);
     int events = 0;
-    std::tie(events, ec) = process.poll(event::out | event::err, infinite);
+    std::tie(events, ec) = process.poll(interests, infinite);
     if (ec) {
       ec = ec == error::broken_pipe ? std::error_code() : ec;
       break;
@@ -52,32 +108,96 @@ std::error_code drain(process &process, Out &&out, Err &&err)
       break;
     }
 
-    stream stream = events & event::out ? stream::out : stream::err;
-
-    size_t bytes_read = 0;
-    std::tie(bytes_read, ec) = process.read(stream, buffer, BUFFER_SIZE);
-    if (ec && ec != error::broken_pipe) {
-      break;
+    if (events & event::in) {
+      if (offset == size) {
+        size_t produced = 0;
+        ec = in(input.data(), input.size(), produced);
+        if (ec) {
+          break;
+        }
+
+        if (produced == 0) {
+          ec = process.close(stream::in);
+          if (ec) {
+            break;
+          }
+
+          writing = false;
+        }
+
+        offset = 0;
+        size = std::min(produced, input.size());
+      }
+
+      if (offset < size) {
+        size_t bytes_written = 0;
+        std::tie(bytes_written, ec) =
+            process.write(input.data() + offset,
+                          std::min(size - offset, WRITE_SIZE));
+        if (ec == error::broken_pipe) {
+          // The child process isn't interested in the rest of the input.
+          writing = false;
+        } else if (ec && ec != error::resource_unavailable_try_again) {
+          break;
+        }
+
+        // On failure, `bytes_written` holds the negated error instead.
+        offset += ec ? 0 : bytes_written;
+      }
     }
 
-    bytes_read = ec == error::broken_pipe ? 0 : bytes_read;
-
-    // This used to be `auto &sink = stream == stream::out ? out : err;` but
-    // that doesn't actually work if `out` and `err` are not the same type.
-    if (stream == stream::out) {
-      ec = out(stream, buffer, bytes_read);
-    } else {
-      ec = err(stream, buffer, bytes_read);
+    // See `reproc_communicate`.
+    for (size_t i = 0; i < 2; i++) {
+      stream stream = (i + turn) % 2 == 0 ? stream::out : stream::err;
+      int ready = stream == stream::out ? event::out : event::err;
+
+      if (!(events & ready)) {
+        continue;
+      }
+
+      size_t bytes_read = 0;
+      std::tie(bytes_read, ec) = process.read(stream, buffer.data(),
+                                              buffer.size());
+      if (ec && ec != error::broken_pipe) {
+        return ec;
+      }
+
+      bytes_read = ec == error::broken_pipe ? 0 : bytes_read;
+
+      // This used to be `auto &sink = stream == stream::out ? out : err;` but
+      // that doesn't actually work if `out` and `err` are not the same type.
+      if (stream == stream::out) {
+        ec = out(stream, buffer.data(), bytes_read);
+      } else {
+        ec = err(stream, buffer.data(), bytes_read);
+      }
+
+      if (ec) {
+        return ec;
+      }
     }
 
-    if (ec) {
-      break;
-    }
+    turn ^= 1;
   }
 
   return ec;
 }
 
+/*!
+`reproc_drain` but takes lambdas as sinks. Return an error code from a sink to
+break out of `drain` early. `out` and `err` expect the following signature:
+
+```c++
+std::error_code sink(stream stream, const uint8_t *buffer, size_t size);
+```
+*/
+template <typename Out, typename Err>
+std::error_code drain(process &process, Out &&out, Err &&err)
+{
+  return communicate(process, source::none(), std::forward<Out>(out),
+                     std::forward<Err>(err));
+}
+
 namespace sink {
 
 /*! Reads all output into `string`. */
@@ -127,6 +247,205 @@ public:
 
 constexpr discard null = discard();
 
+namespace detail {
+
+template <size_t I, typename... Sinks>
+typename std::enable_if<I == sizeof...(Sinks), std::error_code>::type
+tee_apply(std::tuple<Sinks...> &sinks,
+          stream stream,
+          const uint8_t *buffer,
+          size_t size)
+{
+  (void) sinks;
+  (void) stream;
+  (void) buffer;
+  (void) size;
+
+  return {};
+}
+
+template <size_t I, typename... Sinks>
+typename std::enable_if<(I < sizeof...(Sinks)), std::error_code>::type
+tee_apply(std::tuple<Sinks...> &sinks,
+          stream stream,
+          const uint8_t *buffer,
+          size_t size)
+{
+  std::error_code ec = std::get<I>(sinks)(stream, buffer, size);
+  if (ec) {
+    return ec;
+  }
+
+  return tee_apply<I + 1>(sinks, stream, buffer, size);
+}
+
+template <typename... Sinks>
+class tee {
+  std::tuple<Sinks...> sinks_;
+
+public:
+  explicit tee(Sinks... sinks) : sinks_(std::move(sinks)...) {}
+
+  std::error_code operator()(stream stream, const uint8_t *buffer, size_t size)
+  {
+    return tee_apply<0>(sinks_, stream, buffer, size);
+  }
+};
+
+template <typename Predicate, typename Sink>
+class filter {
+  Predicate predicate_;
+  Sink sink_;
+
+public:
+  filter(Predicate predicate, Sink sink)
+      : predicate_(std::move(predicate)), sink_(std::move(sink))
+  {}
+
+  std::error_code operator()(stream stream, const uint8_t *buffer, size_t size)
+  {
+    return predicate_(stream, buffer, size) ? sink_(stream, buffer, size)
+                                            : std::error_code();
+  }
+};
+
+template <typename Sink>
+class limit {
+  size_t remaining_;
+  Sink sink_;
+
+public:
+  limit(size_t size, Sink sink) : remaining_(size), sink_(std::move(sink)) {}
+
+  std::error_code operator()(stream stream, const uint8_t *buffer, size_t size)
+  {
+    if (size > 0 && remaining_ == 0) {
+      return {};
+    }
+
+    size = std::min(size, remaining_);
+    remaining_ -= size;
+
+    return sink_(stream, buffer, size);
+  }
+};
+
+template <typename Sink>
+class timed {
+  Sink sink_;
+
+public:
+  explicit timed(Sink sink) : sink_(std::move(sink)) {}
+
+  std::error_code operator()(stream stream, const uint8_t *buffer, size_t size)
+  {
+    return sink_(stream, buffer, size, now());
+  }
+};
+
+template <typename Sink>
+class sample {
+  size_t every_;
+  size_t count_ = 0;
+  Sink sink_;
+
+public:
+  sample(size_t every, Sink sink) : every_(every), sink_(std::move(sink)) {}
+
+  std::error_code operator()(stream stream, const uint8_t *buffer, size_t size)
+  {
+    if (every_ == 0) {
+      return std::make_error_code(std::errc::invalid_argument);
+    }
+
+    if (size > 0 && count_++ % every_ != 0) {
+      return {};
+    }
+
+    return sink_(stream, buffer, size);
+  }
+};
+
+}
+
+/*!
+Forwards all output to each of `sinks` in order. Stops at the first sink that
+returns an error and returns that error. Sinks are stored by value. Wrap a sink
+in `std::ref` to share it with other code.
+
+The combinators below are templates that the compiler can inline into the
+`drain` loop. Combine them to build pipelines, for example:
+
+```c++
+std::string output;
+auto sink = reproc::sink::tee(
+    reproc::sink::limit(1 << 20, reproc::sink::string(output)),
+    reproc::sink::filter(is_error, logger));
+```
+*/
+template <typename... Sinks>
+detail::tee<typename std::decay<Sinks>::type...> tee(Sinks &&...sinks)
+{
+  return detail::tee<typename std::decay<Sinks>::type...>(
+      std::forward<Sinks>(sinks)...);
+}
+
+/*!
+Forwards output to `sink` only if `predicate` returns true for it. `predicate`
+is called with the same arguments as a sink and returns `bool`.
+*/
+template <typename Predicate, typename Sink>
+detail::filter<typename std::decay<Predicate>::type,
+               typename std::decay<Sink>::type>
+filter(Predicate &&predicate, Sink &&sink)
+{
+  return { std::forward<Predicate>(predicate), std::forward<Sink>(sink) };
+}
+
+/*!
+Forwards the first `size` bytes of output to `sink` and discards the rest. Calls
+with an empty buffer are always forwarded so `sink` still sees the initial call
+and the closing of each stream.
+*/
+template <typename Sink>
+detail::limit<typename std::decay<Sink>::type> limit(size_t size, Sink &&sink)
+{
+  return { size, std::forward<Sink>(sink) };
+}
+
+/*!
+Forwards only every `every`-th chunk of output to `sink`, starting with the
+first one. `every` must be larger than zero, otherwise the sink returns
+`std::errc::invalid_argument`. Calls with an empty buffer are always forwarded
+and not counted.
+*/
+template <typename Sink>
+detail::sample<typename std::decay<Sink>::type> sample(size_t every,
+                                                       Sink &&sink)
+{
+  return { every, std::forward<Sink>(sink) };
+}
+
+/*!
+`reproc_sink_timed`. Forwards output to `sink` together with the `reproc::now`
+timestamp taken right after the output was read. `sink` expects the following
+signature:
+
+```c++
+std::error_code sink(stream stream, const uint8_t *buffer, size_t size,
+                     std::chrono::nanoseconds timestamp);
+```
+
+Pass the same timed sink to both `out` and `err` of `drain` to reconstruct the
+order in which the child process produced output on stdout and stderr.
+*/
+template <typename Sink>
+detail::timed<typename std::decay<Sink>::type> timed(Sink &&sink)
+{
+  return detail::timed<typename std::decay<Sink>::type>(
+      std::forward<Sink>(sink));
+}
+
 namespace thread_safe {
 
 /*! `sink::string` but locks the given mutex before invoking the sink. */
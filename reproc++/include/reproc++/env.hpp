@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include <reproc++/detail/array.hpp>
 #include <reproc++/detail/type_traits.hpp>
 
@@ -13,13 +15,15 @@ public:
   };
 
   env(const char *const *envp = nullptr) // NOLINT
-      : detail::array(envp, false)
+      : detail::array(envp)
   {}
 
   /*!
   `Env` must be iterable as a sequence of string pairs. Examples of
   types that satisfy this requirement are `std::vector<std::pair<std::string,
-  std::string>>` and `std::map<std::string, std::string>`.
+  std::string>>`, `std::map<std::string, std::string>` and
+  `std::vector<std::pair<std::string_view, std::string_view>>`. Each string must
+  provide `data()` and `size()`.
 
   The pairs in `env` represent the extra environment variables of the child
   process and are converted to the right format before being passed as the
@@ -28,49 +32,45 @@ public:
   template <typename Env,
             typename = detail::enable_if_not_char_array<Env>>
   env(const Env &env) // NOLINT
-      : detail::array(from(env), true)
-  {}
+  {
+    from(env);
+  }
 
 private:
   template <typename Env>
-  static const char *const *from(const Env &env);
+  void from(const Env &env);
 };
 
 template <typename Env>
-const char *const *env::from(const Env &env)
+void env::from(const Env &env)
 {
-  using name_size_type = typename Env::value_type::first_type::size_type;
-  using value_size_type = typename Env::value_type::second_type::size_type;
+  std::size_t count = 0;
+  std::size_t size = 0;
+
+  for (const auto &entry : env) {
+    count++;
+    // We add 2 to the size to reserve space for the '=' sign and the NUL
+    // terminator at the end of the string.
+    size += entry.first.size() + entry.second.size() + 2;
+  }
 
-  const char **envp = new const char *[env.size() + 1];
+  const char **envp = allocate(count, size);
+  char *string = reinterpret_cast<char *>(envp + count + 1);
   std::size_t current = 0;
 
   for (const auto &entry : env) {
     const auto &name = entry.first;
     const auto &value = entry.second;
 
-    // We add 2 to the size to reserve space for the '=' sign and the NUL
-    // terminator at the end of the string.
-    char *string = new char[name.size() + value.size() + 2];
-
     envp[current++] = string;
 
-    for (name_size_type i = 0; i < name.size(); i++) {
-      *string++ = name[i];
-    }
-
+    string = std::copy(name.data(), name.data() + name.size(), string);
     *string++ = '=';
-
-    for (value_size_type i = 0; i < value.size(); i++) {
-      *string++ = value[i];
-    }
-
-    *string = '\0';
+    string = std::copy(value.data(), value.data() + value.size(), string);
+    *string++ = '\0';
   }
 
   envp[current] = nullptr;
-
-  return envp;
 }
 
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <reproc++/export.hpp>
+#include <reproc++/worker.hpp>
+
+namespace reproc {
+
+struct pool_options {
+  /*! Amount of workers in the pool. */
+  size_t size = 4;
+
+  /*! Requests that take longer than `timeout` fail with `std::errc::timed_out`
+  and the worker that was handling them is restarted. Other requests in flight
+  on that worker fail with `std::errc::broken_pipe`. */
+  milliseconds timeout = infinite;
+
+  /*! Workers that are restarted by the pool because of a timeout or recycling
+  have their stdin closed and are then stopped with `stop`. */
+  struct stop_actions stop = { { reproc::stop::wait, milliseconds(100) },
+                               { reproc::stop::terminate, milliseconds(100) },
+                               { reproc::stop::kill, infinite } };
+
+  struct {
+    /*! Workers are restarted after handling this many requests. 0 disables
+    recycling based on request count. */
+    size_t requests = 0;
+    /*! Workers are restarted once their resident set size exceeds this many
+    bytes. 0 disables recycling based on memory usage. Only supported on Linux.
+    */
+    size_t rss = 0;
+  } recycle;
+};
+
+/*!
+Dispatches requests to a pool of identical workers. Each request is sent to the
+worker with the least requests in flight. Because workers answer independently
+of each other, responses are returned in completion order and identified by the
+ticket returned from `submit`.
+
+A worker that has `worker_options::depth` requests in flight doesn't accept new
+requests. Neither does a worker that crashed until its restart backoff has
+passed. If every worker is busy or backing off, `submit` waits until a worker
+has room.
+*/
+class pool {
+public:
+  struct result {
+    /*! Ticket returned by the `submit` call of the request. */
+    uint64_t ticket;
+    std::string response;
+    std::error_code error;
+  };
+
+  /*! See `worker::worker`. */
+  REPROCXX_EXPORT pool(const arguments &arguments,
+                       const options &options = {},
+                       worker_options worker_options = {},
+                       pool_options pool_options = {});
+
+  /*! Starts all workers. Workers are started on demand if `start` isn't called.
+  */
+  REPROCXX_EXPORT std::error_code start();
+
+  /*! Sends a request to the least loaded worker and returns a ticket that
+  identifies it. Tickets start at 1. */
+  REPROCXX_EXPORT std::pair<uint64_t, std::error_code>
+  submit(const uint8_t *data, size_t size);
+
+  /*! Returns the result of the first request that completes. If no request
+  completes within `timeout`, the ticket of the result is 0 and its error is
+  `std::errc::timed_out`. If no requests are pending, the error is
+  `std::errc::no_message`. */
+  REPROCXX_EXPORT result receive(milliseconds timeout = infinite);
+
+  /*! Amount of requests that have been submitted but not received yet. */
+  REPROCXX_EXPORT size_t pending() const noexcept;
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct request {
+    uint64_t ticket;
+    clock::time_point deadline;
+  };
+
+  struct slot {
+    class worker worker;
+    // Requests in flight in submission order.
+    std::deque<request> requests;
+    // Requests handled since the worker was last started.
+    size_t served;
+    // Set once the worker should be restarted as soon as it becomes idle.
+    bool retiring;
+    // Set if the worker was stopped by the pool and should be restarted
+    // without backoff.
+    bool stopped;
+  };
+
+  slot *least_loaded();
+  milliseconds backoff();
+  std::error_code collect(milliseconds timeout);
+  void harvest(slot &slot);
+  void expire(slot &slot);
+
+  std::vector<slot> slots_;
+  pool_options pool_options_;
+  uint64_t next_ = 1;
+  std::deque<result> results_;
+};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
@@ -41,11 +42,15 @@ using milliseconds = std::chrono::duration<int, std::milli>;
 REPROCXX_EXPORT extern const milliseconds infinite;
 REPROCXX_EXPORT extern const milliseconds deadline;
 
+/*! `REPROC_LIMIT_INFINITY` */
+REPROCXX_EXPORT extern const uint64_t unlimited;
+
 enum class stop {
   noop,
   wait,
   terminate,
   kill,
+  kill_cgroup,
 };
 
 struct stop_action {
@@ -78,12 +83,66 @@ struct redirect {
     handle_,
     file_,
     path_,
+    socket_,
+    pty_,
   };
 
   enum type type;
   reproc::handle handle;
   FILE *file;
   const char *path;
+
+  struct {
+    bool seqpacket;
+    int buffer;
+  } socket;
+
+  struct {
+    int rows;
+    int columns;
+    bool controlling;
+  } pty;
+};
+
+/*! `REPROC_EXTRA_FDS_MAX` */
+constexpr size_t extra_fds_max = 4;
+
+/*! `reproc_extra_fd` */
+struct extra_fd {
+  int fd;
+  bool input;
+  reproc::handle handle;
+};
+
+struct limit {
+  bool set;
+  uint64_t soft;
+  uint64_t hard;
+};
+
+enum class sched {
+  inherit,
+  other,
+  batch,
+  idle,
+  fifo,
+  rr,
+};
+
+enum class mempolicy {
+  inherit,
+  default_,
+  bind,
+  interleave,
+  preferred,
+  local,
+};
+
+enum class ioprio {
+  inherit,
+  realtime,
+  best_effort,
+  idle,
 };
 
 struct options {
@@ -106,15 +165,84 @@ struct options {
     const char *path;
   } redirect = {};
 
+  /*! See `reproc_options::extra_fds`. */
+  std::array<extra_fd, extra_fds_max> extra_fds = {};
+
   struct stop_actions stop = {};
   reproc::milliseconds timeout = reproc::milliseconds(0);
   reproc::milliseconds deadline = reproc::milliseconds(0);
   /*! Implicitly converts from string literals to the pointer size pair expected
   by `reproc_start`. */
   class input input;
+  /*! Streams stdin from a file. See `reproc_options::input.file`. */
+  struct {
+    reproc::handle handle;
+    const char *path;
+    uint64_t offset;
+    uint64_t length;
+  } input_file = {};
+  /*! See `reproc_options::input.memfd`. */
+  bool input_memfd = false;
   bool nonblocking = false;
+  bool process_group = false;
+  bool session = false;
 
-  /*! Make a shallow copy of `options`. */
+  struct {
+    bool disable;
+  } path_cache = {};
+
+  struct {
+    limit as;
+    limit cpu;
+    limit nofile;
+    limit nproc;
+    limit core;
+    limit fsize;
+  } limits = {};
+
+  struct {
+    struct {
+      const int *cpus;
+      size_t size;
+    } affinity;
+    struct {
+      reproc::mempolicy policy;
+      const int *nodes;
+      size_t size;
+    } memory;
+    struct {
+      bool set;
+      int value;
+    } nice;
+    struct {
+      reproc::sched policy;
+      int priority;
+    } cpu;
+    struct {
+      reproc::ioprio type;
+      int level;
+    } io;
+  } scheduling = {};
+
+  struct {
+    const char *path;
+    uint64_t memory_max;
+    struct {
+      uint64_t quota;
+      uint64_t period;
+    } cpu_max;
+    uint64_t pids_max;
+  } cgroup = {};
+
+  /*! See `reproc_options::ring`. Records are read with
+  `process::ring_read`. */
+  struct {
+    size_t size;
+  } ring = {};
+
+  /*! Make a shallow copy of `options`. The copy borrows `env.extra` from
+  `other` so it's only valid as long as `other`, or whatever `other` is moved
+  to, is alive. */
   static options clone(const options &other)
   {
     struct options clone;
@@ -123,15 +251,55 @@ struct options {
     clone.env.extra = other.env.extra.data();
     clone.working_directory = other.working_directory;
     clone.redirect = other.redirect;
+    clone.extra_fds = other.extra_fds;
     clone.stop = other.stop;
     clone.timeout = other.timeout;
     clone.deadline = other.deadline;
     clone.input = other.input;
+    clone.input_file = other.input_file;
+    clone.input_memfd = other.input_memfd;
+    clone.process_group = other.process_group;
+    clone.session = other.session;
+    clone.path_cache = other.path_cache;
+    clone.limits = other.limits;
+    clone.scheduling = other.scheduling;
+    clone.cgroup = other.cgroup;
+    clone.ring = other.ring;
 
     return clone;
   }
 };
 
+struct cache_stats {
+  size_t hits;
+  size_t misses;
+};
+
+/*! `reproc_path_cache_stats` */
+REPROCXX_EXPORT cache_stats path_cache_stats() noexcept;
+
+/*! `reproc_now` but returns `std::chrono::nanoseconds`. */
+REPROCXX_EXPORT std::chrono::nanoseconds now() noexcept;
+
+/*! `reproc_usage` but CPU times are stored as `std::chrono::microseconds`. */
+struct usage {
+  std::chrono::microseconds utime;
+  std::chrono::microseconds stime;
+  int64_t maxrss;
+  int64_t majflt;
+  int64_t nvcsw;
+  int64_t nivcsw;
+  int64_t inblock;
+  int64_t oublock;
+
+  struct {
+    std::chrono::microseconds usage;
+    std::chrono::microseconds user;
+    std::chrono::microseconds system;
+    int64_t memory_peak;
+  } cgroup;
+};
+
 enum class stream {
   in,
   out,
@@ -183,6 +351,20 @@ public:
 
   REPROCXX_EXPORT std::error_code close(stream stream) noexcept;
 
+  /*! `reproc_read_extra` but returns a pair of (bytes read, error). */
+  REPROCXX_EXPORT std::pair<size_t, std::error_code>
+  read_extra(size_t index, uint8_t *buffer, size_t size) noexcept;
+
+  /*! `reproc_write_extra` but returns a pair of (bytes written, error). */
+  REPROCXX_EXPORT std::pair<size_t, std::error_code>
+  write_extra(size_t index, const uint8_t *buffer, size_t size) noexcept;
+
+  REPROCXX_EXPORT std::error_code close_extra(size_t index) noexcept;
+
+  /*! `reproc_ring_read` */
+  REPROCXX_EXPORT std::error_code ring_read(const uint8_t **data,
+                                            size_t *size) noexcept;
+
   /*! `reproc_wait` but returns a pair of (status, error). */
   REPROCXX_EXPORT std::pair<int, std::error_code>
   wait(milliseconds timeout) noexcept;
@@ -195,6 +377,10 @@ public:
   REPROCXX_EXPORT std::pair<int, std::error_code>
   stop(stop_actions stop) noexcept;
 
+  /*! `reproc_rusage` but returns a pair of (usage, error). Only succeeds after
+  `wait` or `stop` returned the exit status of the process. */
+  REPROCXX_EXPORT std::pair<usage, std::error_code> rusage() noexcept;
+
 private:
   REPROCXX_EXPORT friend std::error_code
   poll(event::source *sources, size_t num_sources, milliseconds timeout);
@@ -210,6 +396,9 @@ enum {
   err = 1 << 2,
   exit = 1 << 3,
   deadline = 1 << 4,
+  /*! `REPROC_EVENT_EXTRA`. The events of `extra_fds[i]` are `extra << i`. */
+  extra = 1 << 5,
+  ring = 1 << 9,
 };
 
 struct source {
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <reproc++/export.hpp>
+#include <reproc++/reproc.hpp>
+
+namespace reproc {
+
+/*! Determines how requests and responses are delimited on the standard streams
+of a worker. */
+enum class framing {
+  /*! Every message is preceded by its size encoded as a 32-bit big-endian
+  unsigned integer. Messages may contain arbitrary bytes. */
+  length,
+  /*! Every message is followed by `worker_options::delimiter`. Messages must
+  not contain the delimiter. */
+  delimiter,
+};
+
+struct worker_options {
+  reproc::framing framing = framing::length;
+  char delimiter = '\n';
+
+  /*! Maximum amount of requests written to the worker before waiting for a
+  response. A depth larger than 1 pipelines requests so the worker can start
+  on the next request while the previous response is still being read. */
+  size_t depth = 1;
+
+  struct {
+    /*! Maximum amount of consecutive restarts without receiving a response in
+    between. Once exceeded, `submit` fails until `start` is called again. */
+    int attempts = 5;
+    /*! Delay before the first restart. The delay doubles with every consecutive
+    restart up to `max_backoff`. `submit` doesn't wait for the delay to pass
+    but fails with `std::errc::resource_unavailable_try_again` until it has
+    (see `worker::retry_after`). */
+    milliseconds backoff = milliseconds(50);
+    milliseconds max_backoff = milliseconds(5000);
+  } restart;
+};
+
+/*!
+Keeps a child process alive across many requests. Requests are written to the
+worker's stdin and responses are read from its stdout, both framed according to
+`worker_options::framing`. The worker has to answer requests in order.
+
+If the worker exits or closes its stdin or stdout, all requests in flight fail
+with `std::errc::broken_pipe` and the next call to `submit` restarts the worker
+with exponential backoff. Calls to `submit` made before the backoff delay has
+passed fail with `std::errc::resource_unavailable_try_again` instead of
+blocking.
+
+Writing to a worker that exited raises `SIGPIPE` on POSIX systems. Ignore
+`SIGPIPE` to get `std::errc::broken_pipe` instead.
+*/
+class worker {
+public:
+  /*!
+  Copies `arguments` and `options.env.extra` so the worker can restart the
+  child process later. Other strings referenced by `options` must outlive the
+  worker.
+
+  The worker always uses pipes for stdin and stdout and puts them in
+  nonblocking mode. `options.input` is not supported. `redirect.parent`,
+  `redirect.discard`, `redirect.file` and `redirect.path` only apply to stderr.
+  If stderr isn't redirected, it goes to the parent's stderr. The worker never
+  reads stderr so if `redirect.err` is a pipe, the caller has to drain it via
+  `process()`.
+  */
+  REPROCXX_EXPORT worker(const arguments &arguments,
+                         const options &options = {},
+                         worker_options worker_options = {});
+
+  /*! Closes the worker's stdin and stops it with the stop actions from
+  `options`. */
+  REPROCXX_EXPORT ~worker() noexcept;
+
+  REPROCXX_EXPORT worker(worker &&other) noexcept;
+
+  /*! Starts the worker process if it isn't running yet and resets the restart
+  counter. `submit` calls `start` automatically. */
+  REPROCXX_EXPORT std::error_code start();
+
+  /*! Writes a request to the worker. If `depth` requests are in flight, the
+  response to the oldest one is read first and buffered for `receive`. */
+  REPROCXX_EXPORT std::error_code submit(const uint8_t *data, size_t size);
+
+  /*! Returns the response to the oldest request that hasn't been received yet.
+  Returns `std::errc::timed_out` if no response arrives within `timeout`, in
+  which case the request remains in flight. */
+  REPROCXX_EXPORT std::pair<std::string, std::error_code>
+  receive(milliseconds timeout = infinite);
+
+  /*! `submit` followed by `receive`. */
+  REPROCXX_EXPORT std::pair<std::string, std::error_code>
+  call(const uint8_t *data, size_t size, milliseconds timeout = infinite);
+
+  /*! Amount of requests that have been submitted but not received yet. */
+  REPROCXX_EXPORT size_t pending() const noexcept;
+
+  /*! Time left until `submit` may restart the worker after it exited. Zero if
+  the worker is running or may be restarted right away. */
+  REPROCXX_EXPORT milliseconds retry_after() const noexcept;
+
+  /*! Closes the worker's stdin and stops it with `stop`. Requests in flight
+  fail with `std::errc::broken_pipe`. */
+  REPROCXX_EXPORT std::pair<int, std::error_code> stop(stop_actions stop);
+
+  /*! The underlying process. Only valid while the worker is running. */
+  REPROCXX_EXPORT class process &process() noexcept;
+
+private:
+  friend class pool;
+
+  using clock = std::chrono::steady_clock;
+
+  std::error_code launch();
+  std::error_code restart();
+  void backoff();
+  std::error_code pump(int interests, milliseconds timeout);
+  std::error_code read(milliseconds timeout);
+  bool next(std::string &message);
+  std::error_code fail(std::error_code ec);
+
+  std::vector<std::string> arguments_;
+  std::vector<std::string> env_;
+  std::vector<const char *> env_pointers_;
+  reproc::options options_;
+  reproc::worker_options worker_options_;
+
+  class process process_;
+  bool started_ = false;
+  bool running_ = false;
+  int restarts_ = 0;
+  // The worker isn't restarted before this point in time.
+  clock::time_point relaunch_;
+
+  // The current request and the amount of bytes of it that have been written.
+  std::string request_;
+  size_t written_ = 0;
+  // Bytes read from stdout that don't form a complete response yet.
+  std::string buffer_;
+  // Results that haven't been returned by `receive` yet, in request order.
+  std::deque<std::pair<std::string, std::error_code>> results_;
+  // Requests that were written but whose responses haven't been read yet.
+  size_t unanswered_ = 0;
+};
+
+}
@@ -0,0 +1,66 @@
+#ifndef _WIN32
+  #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+  #define getpid (int) GetCurrentProcessId
+  #define millisleep(ms) Sleep(ms)
+#else
+  #include <time.h>
+  #include <unistd.h>
+static void millisleep(long ms)
+{
+  nanosleep(&(struct timespec){ .tv_sec = ms / 1000,
+                                .tv_nsec = (ms % 1000) * 1000000 },
+            NULL);
+}
+#endif
+
+// Amount of memory allocated by "grow".
+enum { GROW_SIZE = 64 * 1024 * 1024 };
+
+// Echoes every line it reads back to stdout until stdin is closed. A few lines
+// are handled differently:
+// - "crash": Exits without answering.
+// - "pid": Answers with the process ID of the worker.
+// - "grow": Allocates and touches `GROW_SIZE` bytes before answering.
+// - "hang": Never answers.
+int main(void)
+{
+  char line[8096];
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    if (strcmp(line, "crash\n") == 0) {
+      return EXIT_FAILURE;
+    }
+
+    if (strcmp(line, "pid\n") == 0) {
+      snprintf(line, sizeof(line), "%d\n", getpid());
+    }
+
+    if (strcmp(line, "grow\n") == 0) {
+      char *memory = malloc(GROW_SIZE);
+      if (memory == NULL) {
+        return EXIT_FAILURE;
+      }
+
+      memset(memory, 1, GROW_SIZE);
+    }
+
+    if (strcmp(line, "hang\n") == 0) {
+      for (;;) {
+        millisleep(1000);
+      }
+    }
+
+    fputs(line, stdout);
+    fflush(stdout);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,323 @@
+#include <reproc++/pool.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+  #include <fstream>
+  #include <unistd.h>
+#endif
+
+namespace reproc {
+
+// Returns the resident set size in bytes of the process with the given pid or 0
+// if it can't be determined.
+static size_t resident(int pid)
+{
+#if defined(__linux__)
+  std::ifstream statm("/proc/" + std::to_string(pid) + "/statm");
+  size_t size = 0;
+  size_t pages = 0;
+
+  if (!(statm >> size >> pages)) {
+    return 0;
+  }
+
+  return pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  (void) pid;
+  return 0;
+#endif
+}
+
+pool::pool(const arguments &arguments,
+           const options &options,
+           struct worker_options worker_options,
+           struct pool_options pool_options)
+    : pool_options_(pool_options)
+{
+  slots_.reserve(pool_options.size);
+
+  for (size_t i = 0; i < pool_options.size; i++) {
+    slots_.push_back(
+        { worker(arguments, options, worker_options), {}, 0, false, false });
+  }
+}
+
+std::error_code pool::start()
+{
+  for (slot &slot : slots_) {
+    std::error_code ec = slot.worker.start();
+    if (ec) {
+      return ec;
+    }
+  }
+
+  return {};
+}
+
+pool::slot *pool::least_loaded()
+{
+  slot *best = nullptr;
+
+  for (slot &slot : slots_) {
+    if (slot.retiring ||
+        slot.requests.size() >= slot.worker.worker_options_.depth) {
+      continue;
+    }
+
+    // Workers that crashed can't be restarted until their backoff has passed.
+    // Workers stopped by the pool are restarted without backoff.
+    if (!slot.stopped && slot.worker.retry_after() > milliseconds(0)) {
+      continue;
+    }
+
+    if (best == nullptr || slot.requests.size() < best->requests.size()) {
+      best = &slot;
+    }
+  }
+
+  return best;
+}
+
+milliseconds pool::backoff()
+{
+  milliseconds shortest = infinite;
+
+  for (slot &slot : slots_) {
+    if (slot.retiring || slot.stopped ||
+        slot.requests.size() >= slot.worker.worker_options_.depth) {
+      continue;
+    }
+
+    milliseconds left = slot.worker.retry_after();
+    if (left > milliseconds(0)) {
+      shortest = shortest == infinite ? left : std::min(shortest, left);
+    }
+  }
+
+  return shortest;
+}
+
+void pool::harvest(slot &slot)
+{
+  class worker &worker = slot.worker;
+  bool answered = false;
+
+  while (!worker.results_.empty() && !slot.requests.empty()) {
+    std::pair<std::string, std::error_code> &front = worker.results_.front();
+    results_.push_back(
+        { slot.requests.front().ticket, std::move(front.first), front.second });
+    answered = answered || !front.second;
+
+    worker.results_.pop_front();
+    slot.requests.pop_front();
+  }
+
+  if (!worker.running_) {
+    // The worker will be restarted by the next request anyway.
+    slot.retiring = false;
+    return;
+  }
+
+  if (answered && pool_options_.recycle.rss > 0 &&
+      resident(worker.process_.pid().first) > pool_options_.recycle.rss) {
+    slot.retiring = true;
+  }
+
+  if (slot.retiring && slot.requests.empty()) {
+    worker.stop(pool_options_.stop);
+    slot.retiring = false;
+    slot.stopped = true;
+  }
+}
+
+void pool::expire(slot &slot)
+{
+  class worker &worker = slot.worker;
+  size_t first = worker.results_.size();
+
+  worker.stop(pool_options_.stop);
+
+  // The oldest request in flight is the one that timed out. The others only
+  // fail because they were running on the same worker.
+  if (first < worker.results_.size()) {
+    worker.results_[first].second = std::make_error_code(std::errc::timed_out);
+  }
+
+  slot.stopped = true;
+  harvest(slot);
+}
+
+std::error_code pool::collect(milliseconds timeout)
+{
+  clock::time_point now = clock::now();
+  std::vector<event::source> sources;
+  std::vector<slot *> polled;
+
+  for (slot &slot : slots_) {
+    if (slot.requests.empty() || !slot.worker.running_) {
+      continue;
+    }
+
+    clock::time_point deadline = slot.requests.front().deadline;
+
+    if (deadline != clock::time_point::max()) {
+      milliseconds left = std::max(
+          std::chrono::duration_cast<milliseconds>(deadline - now),
+          milliseconds(0));
+      timeout = timeout == infinite ? left : std::min(timeout, left);
+    }
+
+    sources.push_back({ std::move(slot.worker.process_), event::out, 0 });
+    polled.push_back(&slot);
+  }
+
+  if (sources.empty()) {
+    return std::make_error_code(std::errc::no_message);
+  }
+
+  std::error_code ec = poll(sources.data(), sources.size(), timeout);
+
+  for (size_t i = 0; i < sources.size(); i++) {
+    polled[i]->worker.process_ = std::move(sources[i].process);
+  }
+
+  if (ec) {
+    return ec;
+  }
+
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (!(sources[i].events & event::out)) {
+      continue;
+    }
+
+    class worker &worker = polled[i]->worker;
+
+    // Read every response that's available without blocking.
+    while (worker.unanswered_ > 0 && !worker.read(milliseconds(0))) {}
+
+    harvest(*polled[i]);
+  }
+
+  now = clock::now();
+
+  for (slot &slot : slots_) {
+    if (!slot.requests.empty() && slot.requests.front().deadline <= now) {
+      expire(slot);
+    }
+  }
+
+  return {};
+}
+
+std::pair<uint64_t, std::error_code> pool::submit(const uint8_t *data,
+                                                  size_t size)
+{
+  if (slots_.empty()) {
+    return { 0, std::make_error_code(std::errc::invalid_argument) };
+  }
+
+  slot *slot = nullptr;
+  std::error_code ec;
+
+  while ((slot = least_loaded()) == nullptr) {
+    // Stop collecting responses once a worker that's backing off after a crash
+    // can be restarted.
+    milliseconds timeout = backoff();
+
+    ec = collect(timeout);
+    if (ec == std::errc::no_message && timeout != infinite) {
+      // No requests are in flight so there's nothing to do in the meantime.
+      std::this_thread::sleep_for(timeout);
+      continue;
+    }
+
+    if (ec) {
+      return { 0, ec };
+    }
+  }
+
+  if (!slot->worker.running_) {
+    slot->served = 0;
+  }
+
+  if (slot->stopped) {
+    // Workers stopped by the pool are restarted immediately instead of with
+    // the backoff used after a crash.
+    slot->stopped = false;
+
+    ec = slot->worker.start();
+    if (ec) {
+      return { 0, ec };
+    }
+  }
+
+  ec = slot->worker.submit(data, size);
+  // Submitting fails the requests in flight if the worker exited.
+  harvest(*slot);
+  if (ec) {
+    return { 0, ec };
+  }
+
+  clock::time_point deadline = pool_options_.timeout == infinite
+                                   ? clock::time_point::max()
+                                   : clock::now() + pool_options_.timeout;
+
+  slot->requests.push_back({ next_, deadline });
+  slot->served++;
+
+  if (pool_options_.recycle.requests > 0 &&
+      slot->served >= pool_options_.recycle.requests) {
+    slot->retiring = true;
+  }
+
+  return { next_++, {} };
+}
+
+pool::result pool::receive(milliseconds timeout)
+{
+  clock::time_point start = clock::now();
+
+  while (results_.empty()) {
+    if (pending() == 0) {
+      return { 0, std::string(), std::make_error_code(std::errc::no_message) };
+    }
+
+    milliseconds remaining = infinite;
+
+    if (timeout != infinite) {
+      auto elapsed = std::chrono::duration_cast<milliseconds>(clock::now() -
+                                                              start);
+      remaining = std::max(timeout - elapsed, milliseconds(0));
+    }
+
+    std::error_code ec = collect(remaining);
+    if (ec) {
+      return { 0, std::string(), ec };
+    }
+
+    if (results_.empty() && remaining == milliseconds(0)) {
+      return { 0, std::string(), std::make_error_code(std::errc::timed_out) };
+    }
+  }
+
+  result result = std::move(results_.front());
+  results_.pop_front();
+
+  return result;
+}
+
+size_t pool::pending() const noexcept
+{
+  size_t pending = results_.size();
+
+  for (const slot &slot : slots_) {
+    pending += slot.requests.size();
+  }
+
+  return pending;
+}
+
+}
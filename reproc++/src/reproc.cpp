@@ -1,6 +1,8 @@
 #include <reproc++/reproc.hpp>
 
+#include <reproc/drain.h>
 #include <reproc/reproc.h>
+#include <reproc/ring.h>
 
 namespace reproc {
 
@@ -14,6 +16,8 @@ const int terminate = REPROC_SIGTERM;
 const milliseconds infinite = milliseconds(REPROC_INFINITE);
 const milliseconds deadline = milliseconds(REPROC_DEADLINE);
 
+const uint64_t unlimited = REPROC_LIMIT_INFINITY;
+
 static std::error_code error_code_from(int r)
 {
   if (r >= 0) {
@@ -41,25 +45,88 @@ static reproc_stop_actions reproc_stop_actions_from(stop_actions stop)
 
 static reproc_redirect reproc_redirect_from(redirect redirect)
 {
-  return { static_cast<REPROC_REDIRECT>(redirect.type), redirect.handle,
-           redirect.file, redirect.path };
+  return { static_cast<REPROC_REDIRECT>(redirect.type),
+           redirect.handle,
+           redirect.file,
+           redirect.path,
+           { redirect.socket.seqpacket, redirect.socket.buffer },
+           { redirect.pty.rows, redirect.pty.columns,
+             redirect.pty.controlling } };
+}
+
+static_assert(extra_fds_max == REPROC_EXTRA_FDS_MAX,
+              "extra_fds_max must match REPROC_EXTRA_FDS_MAX");
+
+static reproc_limit reproc_limit_from(limit limit)
+{
+  return { limit.set, limit.soft, limit.hard };
 }
 
 static reproc_options reproc_options_from(const options &options, bool fork)
 {
-  return {
-    options.working_directory,
-    { static_cast<REPROC_ENV>(options.env.behavior), options.env.extra.data() },
-    { reproc_redirect_from(options.redirect.in),
-      reproc_redirect_from(options.redirect.out),
-      reproc_redirect_from(options.redirect.err), options.redirect.parent,
-      options.redirect.discard, options.redirect.file, options.redirect.path },
-    reproc_stop_actions_from(options.stop),
-    options.deadline.count(),
-    { options.input.data(), options.input.size() },
-    options.nonblocking,
-    fork
-  };
+  // Assign each member separately so we don't depend on the member order of
+  // `reproc_options`.
+  reproc_options result = {};
+
+  result.working_directory = options.working_directory;
+  result.env.behavior = static_cast<REPROC_ENV>(options.env.behavior);
+  result.env.extra = options.env.extra.data();
+  result.redirect.in = reproc_redirect_from(options.redirect.in);
+  result.redirect.out = reproc_redirect_from(options.redirect.out);
+  result.redirect.err = reproc_redirect_from(options.redirect.err);
+  result.redirect.parent = options.redirect.parent;
+  result.redirect.discard = options.redirect.discard;
+  result.redirect.file = options.redirect.file;
+  result.redirect.path = options.redirect.path;
+
+  for (size_t i = 0; i < extra_fds_max; i++) {
+    result.extra_fds[i].fd = options.extra_fds[i].fd;
+    result.extra_fds[i].input = options.extra_fds[i].input;
+    result.extra_fds[i].handle = options.extra_fds[i].handle;
+  }
+
+  result.stop = reproc_stop_actions_from(options.stop);
+  result.deadline = options.deadline.count();
+  result.input.data = options.input.data();
+  result.input.size = options.input.size();
+  result.input.file.handle = options.input_file.handle;
+  result.input.file.path = options.input_file.path;
+  result.input.file.offset = options.input_file.offset;
+  result.input.file.length = options.input_file.length;
+  result.input.memfd = options.input_memfd;
+  result.fork = fork;
+  result.nonblocking = options.nonblocking;
+  result.process_group = options.process_group;
+  result.session = options.session;
+  result.path_cache.disable = options.path_cache.disable;
+  result.limits.as = reproc_limit_from(options.limits.as);
+  result.limits.cpu = reproc_limit_from(options.limits.cpu);
+  result.limits.nofile = reproc_limit_from(options.limits.nofile);
+  result.limits.nproc = reproc_limit_from(options.limits.nproc);
+  result.limits.core = reproc_limit_from(options.limits.core);
+  result.limits.fsize = reproc_limit_from(options.limits.fsize);
+  result.scheduling.affinity.cpus = options.scheduling.affinity.cpus;
+  result.scheduling.affinity.size = options.scheduling.affinity.size;
+  result.scheduling.memory.policy = static_cast<REPROC_MEMPOLICY>(
+      options.scheduling.memory.policy);
+  result.scheduling.memory.nodes = options.scheduling.memory.nodes;
+  result.scheduling.memory.size = options.scheduling.memory.size;
+  result.scheduling.nice.set = options.scheduling.nice.set;
+  result.scheduling.nice.value = options.scheduling.nice.value;
+  result.scheduling.cpu.policy = static_cast<REPROC_SCHED>(
+      options.scheduling.cpu.policy);
+  result.scheduling.cpu.priority = options.scheduling.cpu.priority;
+  result.scheduling.io.type = static_cast<REPROC_IOPRIO>(
+      options.scheduling.io.type);
+  result.scheduling.io.level = options.scheduling.io.level;
+  result.cgroup.path = options.cgroup.path;
+  result.cgroup.memory_max = options.cgroup.memory_max;
+  result.cgroup.cpu_max.quota = options.cgroup.cpu_max.quota;
+  result.cgroup.cpu_max.period = options.cgroup.cpu_max.period;
+  result.cgroup.pids_max = options.cgroup.pids_max;
+  result.ring.size = options.ring.size;
+
+  return result;
 }
 
 process::process() : impl_(reproc_new(), reproc_destroy) {}
@@ -113,6 +180,32 @@ std::error_code process::close(stream stream) noexcept
   return error_code_from(r);
 }
 
+std::pair<size_t, std::error_code>
+process::read_extra(size_t index, uint8_t *buffer, size_t size) noexcept
+{
+  int r = reproc_read_extra(impl_.get(), index, buffer, size);
+  return { r, error_code_from(r) };
+}
+
+std::pair<size_t, std::error_code>
+process::write_extra(size_t index, const uint8_t *buffer, size_t size) noexcept
+{
+  int r = reproc_write_extra(impl_.get(), index, buffer, size);
+  return { r, error_code_from(r) };
+}
+
+std::error_code process::close_extra(size_t index) noexcept
+{
+  int r = reproc_close_extra(impl_.get(), index);
+  return error_code_from(r);
+}
+
+std::error_code process::ring_read(const uint8_t **data, size_t *size) noexcept
+{
+  int r = reproc_ring_read(impl_.get(), data, size);
+  return error_code_from(r);
+}
+
 std::pair<int, std::error_code> process::wait(milliseconds timeout) noexcept
 {
   int r = reproc_wait(impl_.get(), timeout.count());
@@ -137,12 +230,44 @@ std::pair<int, std::error_code> process::stop(stop_actions stop) noexcept
   return { r, error_code_from(r) };
 }
 
+std::pair<usage, std::error_code> process::rusage() noexcept
+{
+  reproc_usage usage = {};
+  int r = reproc_rusage(impl_.get(), &usage);
+
+  struct usage result = { std::chrono::microseconds(usage.utime),
+                          std::chrono::microseconds(usage.stime),
+                          usage.maxrss,
+                          usage.majflt,
+                          usage.nvcsw,
+                          usage.nivcsw,
+                          usage.inblock,
+                          usage.oublock,
+                          { std::chrono::microseconds(usage.cgroup.usage),
+                            std::chrono::microseconds(usage.cgroup.user),
+                            std::chrono::microseconds(usage.cgroup.system),
+                            usage.cgroup.memory_peak } };
+
+  return { result, error_code_from(r) };
+}
+
 std::pair<int, std::error_code> process::pid() noexcept
 {
   int r = reproc_pid(impl_.get());
   return { r, error_code_from(r) };
 }
 
+cache_stats path_cache_stats() noexcept
+{
+  reproc_cache_stats stats = reproc_path_cache_stats();
+  return { stats.hits, stats.misses };
+}
+
+std::chrono::nanoseconds now() noexcept
+{
+  return std::chrono::nanoseconds(reproc_now());
+}
+
 std::error_code
 poll(event::source *sources, size_t num_sources, milliseconds timeout)
 {
@@ -0,0 +1,409 @@
+#include <reproc++/worker.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
+namespace reproc {
+
+static constexpr size_t HEADER_SIZE = 4;
+static constexpr size_t BUFFER_SIZE = 65536;
+
+static std::vector<std::string> strings_from(const char *const *array)
+{
+  std::vector<std::string> strings;
+
+  for (; array != nullptr && *array != nullptr; array++) {
+    strings.emplace_back(*array);
+  }
+
+  return strings;
+}
+
+worker::worker(const arguments &arguments,
+               const options &options,
+               struct worker_options worker_options)
+    : arguments_(strings_from(arguments.data())),
+      env_(strings_from(options.env.extra.data())),
+      options_(options::clone(options)),
+      worker_options_(worker_options)
+{
+  for (const std::string &variable : env_) {
+    env_pointers_.push_back(variable.c_str());
+  }
+
+  env_pointers_.push_back(nullptr);
+
+  options_.env.extra = env_pointers_.data();
+  options_.redirect.in.type = redirect::pipe;
+  options_.redirect.out.type = redirect::pipe;
+
+  // The worker owns stdin and stdout so the shorthands in `options.redirect`
+  // only apply to stderr. Nothing drains a stderr pipe so unless the caller
+  // redirected stderr, it goes to the parent's stderr.
+  struct redirect &err = options_.redirect.err;
+  if (err.type == redirect::default_ && !err.handle && err.file == nullptr &&
+      err.path == nullptr) {
+    if (options_.redirect.discard) {
+      err.type = redirect::discard;
+    } else if (options_.redirect.file != nullptr) {
+      err.type = redirect::file_;
+      err.file = options_.redirect.file;
+    } else if (options_.redirect.path != nullptr) {
+      err.type = redirect::path_;
+      err.path = options_.redirect.path;
+    } else {
+      err.type = redirect::parent;
+    }
+  }
+
+  options_.redirect.parent = false;
+  options_.redirect.discard = false;
+  options_.redirect.file = nullptr;
+  options_.redirect.path = nullptr;
+  options_.nonblocking = true;
+  worker_options_.depth = std::max<size_t>(worker_options_.depth, 1);
+}
+
+worker::~worker() noexcept
+{
+  if (running_) {
+    process_.close(stream::in);
+  }
+}
+
+worker::worker(worker &&other) noexcept = default;
+
+std::error_code worker::launch()
+{
+  if (options_.input.size() > 0) {
+    return std::make_error_code(std::errc::invalid_argument);
+  }
+
+  process_ = reproc::process();
+  buffer_.clear();
+
+  std::error_code ec = process_.start(arguments_, options_);
+  started_ = true;
+  running_ = !ec;
+
+  return ec;
+}
+
+std::error_code worker::start()
+{
+  restarts_ = 0;
+  return running_ ? std::error_code() : launch();
+}
+
+std::error_code worker::restart()
+{
+  if (!started_) {
+    return launch();
+  }
+
+  if (restarts_ >= worker_options_.restart.attempts) {
+    return std::make_error_code(std::errc::broken_pipe);
+  }
+
+  // Instead of sleeping until the backoff delay has passed, we let the caller
+  // decide what to do in the meantime.
+  if (clock::now() < relaunch_) {
+    return std::make_error_code(std::errc::resource_unavailable_try_again);
+  }
+
+  restarts_++;
+
+  std::error_code ec = launch();
+  if (ec) {
+    backoff();
+  }
+
+  return ec;
+}
+
+void worker::backoff()
+{
+  milliseconds delay = worker_options_.restart.backoff;
+  for (int i = 0; i < restarts_ && delay < worker_options_.restart.max_backoff;
+       i++) {
+    delay *= 2;
+  }
+
+  relaunch_ = clock::now() + std::min(delay,
+                                      worker_options_.restart.max_backoff);
+}
+
+std::error_code worker::fail(std::error_code ec)
+{
+  for (; unanswered_ > 0; unanswered_--) {
+    results_.emplace_back(std::string(),
+                          std::make_error_code(std::errc::broken_pipe));
+  }
+
+  // A well-behaved worker exits when its stdin is closed which keeps the stop
+  // actions in `options` from blocking if the worker only closed its stdout.
+  process_.close(stream::in);
+  process_ = reproc::process();
+  running_ = false;
+  backoff();
+
+  return ec;
+}
+
+std::error_code worker::pump(int interests, milliseconds timeout)
+{
+  int events = 0;
+  std::error_code ec;
+
+  std::tie(events, ec) = process_.poll(interests, timeout);
+  if (ec) {
+    return ec;
+  }
+
+  if (events == 0 || events & event::deadline) {
+    return std::make_error_code(std::errc::timed_out);
+  }
+
+  if (events & event::in) {
+    size_t bytes_written = 0;
+    std::tie(bytes_written, ec) = process_.write(
+        reinterpret_cast<const uint8_t *>(request_.data()) + written_,
+        request_.size() - written_);
+    if (ec == std::errc::resource_unavailable_try_again) {
+      bytes_written = 0;
+    } else if (ec) {
+      return ec;
+    }
+
+    written_ += bytes_written;
+  }
+
+  if (events & event::out) {
+    uint8_t buffer[BUFFER_SIZE];
+    size_t bytes_read = 0;
+
+    std::tie(bytes_read, ec) = process_.read(stream::out, buffer, BUFFER_SIZE);
+    if (ec == std::errc::resource_unavailable_try_again) {
+      bytes_read = 0;
+    } else if (ec) {
+      return ec;
+    }
+
+    buffer_.append(reinterpret_cast<const char *>(buffer), bytes_read);
+  }
+
+  return {};
+}
+
+bool worker::next(std::string &message)
+{
+  if (worker_options_.framing == framing::delimiter) {
+    size_t end = buffer_.find(worker_options_.delimiter);
+    if (end == std::string::npos) {
+      return false;
+    }
+
+    message.assign(buffer_, 0, end);
+    buffer_.erase(0, end + 1);
+
+    return true;
+  }
+
+  if (buffer_.size() < HEADER_SIZE) {
+    return false;
+  }
+
+  size_t size = 0;
+  for (size_t i = 0; i < HEADER_SIZE; i++) {
+    size = size << 8 | static_cast<uint8_t>(buffer_[i]);
+  }
+
+  if (buffer_.size() - HEADER_SIZE < size) {
+    return false;
+  }
+
+  message.assign(buffer_, HEADER_SIZE, size);
+  buffer_.erase(0, HEADER_SIZE + size);
+
+  return true;
+}
+
+std::error_code worker::read(milliseconds timeout)
+{
+  using clock = std::chrono::steady_clock;
+  clock::time_point start = clock::now();
+  std::string message;
+
+  while (!next(message)) {
+    milliseconds remaining = infinite;
+
+    if (timeout != infinite) {
+      auto elapsed = std::chrono::duration_cast<milliseconds>(clock::now() -
+                                                              start);
+      remaining = std::max(timeout - elapsed, milliseconds(0));
+    }
+
+    std::error_code ec = pump(event::out, remaining);
+    if (ec == std::errc::timed_out) {
+      return ec;
+    }
+
+    if (ec) {
+      return fail(ec);
+    }
+  }
+
+  results_.emplace_back(std::move(message), std::error_code());
+  unanswered_--;
+  restarts_ = 0;
+
+  return {};
+}
+
+std::error_code worker::submit(const uint8_t *data, size_t size)
+{
+  const char *begin = reinterpret_cast<const char *>(data);
+  std::error_code ec;
+
+  switch (worker_options_.framing) {
+    case framing::length:
+      if (size > UINT32_MAX) {
+        return std::make_error_code(std::errc::invalid_argument);
+      }
+
+      request_.clear();
+      for (size_t i = HEADER_SIZE; i > 0; i--) {
+        request_.push_back(static_cast<char>(size >> ((i - 1) * 8) & 0xff));
+      }
+
+      request_.append(begin, size);
+      break;
+
+    case framing::delimiter:
+      if (std::memchr(data, worker_options_.delimiter, size) != nullptr) {
+        return std::make_error_code(std::errc::invalid_argument);
+      }
+
+      request_.assign(begin, size);
+      request_.push_back(worker_options_.delimiter);
+      break;
+  }
+
+  while (unanswered_ >= worker_options_.depth && running_) {
+    ec = read(infinite);
+    if (ec) {
+      return ec;
+    }
+  }
+
+  // A worker might have exited while it was idle in which case we only notice
+  // when writing to it. Since none of the request was written yet, it's safe to
+  // restart the worker and try again.
+  for (;;) {
+    if (!running_) {
+      ec = restart();
+      if (ec) {
+        return ec;
+      }
+    }
+
+    written_ = 0;
+
+    while (written_ < request_.size()) {
+      // Keep reading responses while writing so a worker that blocks on
+      // writing a response can't keep us from writing the rest of the request.
+      ec = pump(event::in | event::out, infinite);
+      if (ec) {
+        break;
+      }
+    }
+
+    if (!ec) {
+      break;
+    }
+
+    bool retry = written_ == 0 && unanswered_ == 0;
+    fail(ec);
+
+    if (!retry) {
+      return ec;
+    }
+  }
+
+  unanswered_++;
+
+  return {};
+}
+
+std::pair<std::string, std::error_code> worker::receive(milliseconds timeout)
+{
+  if (results_.empty()) {
+    if (unanswered_ == 0) {
+      return { std::string(), std::make_error_code(std::errc::no_message) };
+    }
+
+    std::error_code ec = read(timeout);
+    if (ec && results_.empty()) {
+      return { std::string(), ec };
+    }
+  }
+
+  std::pair<std::string, std::error_code> result = std::move(results_.front());
+  results_.pop_front();
+
+  return result;
+}
+
+std::pair<std::string, std::error_code>
+worker::call(const uint8_t *data, size_t size, milliseconds timeout)
+{
+  std::error_code ec = submit(data, size);
+  if (ec) {
+    return { std::string(), ec };
+  }
+
+  return receive(timeout);
+}
+
+size_t worker::pending() const noexcept
+{
+  return results_.size() + unanswered_;
+}
+
+milliseconds worker::retry_after() const noexcept
+{
+  clock::time_point now = clock::now();
+
+  if (running_ || now >= relaunch_) {
+    return milliseconds(0);
+  }
+
+  // Round up so waiting for the returned time is always long enough.
+  auto left = relaunch_ - now;
+  milliseconds rounded = std::chrono::duration_cast<milliseconds>(left);
+
+  return rounded < left ? rounded + milliseconds(1) : rounded;
+}
+
+std::pair<int, std::error_code> worker::stop(stop_actions stop)
+{
+  if (!running_) {
+    return { 0, std::error_code() };
+  }
+
+  process_.close(stream::in);
+
+  std::pair<int, std::error_code> result = process_.stop(stop);
+  fail({});
+
+  return result;
+}
+
+class process &worker::process() noexcept
+{
+  return process_;
+}
+
+}
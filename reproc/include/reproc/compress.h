@@ -0,0 +1,81 @@
+#pragma once
+
+#include <reproc/drain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+Compresses the output of a child process while it is being drained. Output is
+split in blocks of 64 KiB that are compressed independently and written as a
+single LZ4 frame which can be decompressed with `lz4 -d` or any other LZ4 frame
+decoder. Memory usage is bounded by the amount of queued blocks regardless of
+how much output is compressed.
+
+Only available if reproc was built with `REPROC_COMPRESSION`.
+*/
+typedef struct reproc_compressor reproc_compressor;
+
+typedef struct reproc_compress_options {
+  /*!
+  Receives the compressed output. `function` is called with `context` each time
+  a block is compressed. If `function` returns a non-zero value, compression
+  stops and the same value is returned by the sink and by
+  `reproc_compressor_finish`.
+  */
+  struct {
+    int (*function)(const uint8_t *buffer, size_t size, void *context);
+    void *context;
+  } output;
+  /*!
+  Write the compressed output to `file` instead. reproc does not take ownership
+  of the file. Exactly one of `output.function` and `file` must be set.
+  */
+  FILE *file;
+  /*!
+  Compress on a separate thread so the sink only has to copy output into a
+  queued block. The sink only blocks if the thread falls behind by more than
+  `queue` blocks. `output` is called on the compression thread.
+
+  If reproc was built without `REPROC_MULTITHREADED` or on Windows,
+  `reproc_compressor_new` fails if `thread` is set.
+  */
+  bool thread;
+  /*! Amount of blocks queued for the compression thread. Defaults to 4. */
+  size_t queue;
+} reproc_compress_options;
+
+/*! Allocates a new compressor. Returns `NULL` if `options` are invalid or
+allocating the compressor fails. */
+REPROC_EXPORT reproc_compressor *
+reproc_compressor_new(reproc_compress_options options);
+
+/*!
+Compresses the output of a process with `compressor`. The same compressor may
+be passed to both `out` and `err`. Output is compressed in the order the sink
+receives it.
+
+The sink returns the error of a previous failed write of the compressed output,
+if any.
+*/
+REPROC_EXPORT reproc_sink reproc_sink_compress(reproc_compressor *compressor);
+
+/*!
+Compresses the remaining output and ends the frame. With `thread`, waits for
+the compression thread to write every queued block. Flushes `file` if it was
+set. Afterwards, the sink returns `REPROC_EINVAL`.
+
+Returns the first error that occurred while writing the compressed output.
+*/
+REPROC_EXPORT int reproc_compressor_finish(reproc_compressor *compressor);
+
+/*! Stops the compression thread (without ending the frame if
+`reproc_compressor_finish` wasn't called) and releases the resources of
+`compressor`. Always returns `NULL`. */
+REPROC_EXPORT reproc_compressor *
+reproc_compressor_destroy(reproc_compressor *compressor);
+
+#ifdef __cplusplus
+}
+#endif
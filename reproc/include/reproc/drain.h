@@ -21,6 +21,24 @@ typedef struct reproc_sink {
 redirected to a pipe. */
 REPROC_EXPORT extern const reproc_sink REPROC_SINK_NULL;
 
+/*! Used by `reproc_communicate` to obtain the input of the child process. Each
+time stdin can be written to and all previous input has been written,
+`function` is called with `context` to fill `buffer` with at most `size` bytes.
+`function` stores the amount of bytes it produced in `produced`. Producing zero
+bytes ends the input, after which stdin is closed. If a source returns a
+non-zero value, `reproc_communicate` will return immediately with the same
+value. */
+typedef struct reproc_source {
+  int (*function)(uint8_t *buffer,
+                  size_t size,
+                  size_t *produced,
+                  void *context);
+  void *context;
+} reproc_source;
+
+/*! Pass `REPROC_SOURCE_NULL` as the source to leave stdin alone. */
+REPROC_EXPORT extern const reproc_source REPROC_SOURCE_NULL;
+
 /*!
 Reads from the child process stdout and stderr until an error occurs or both
 streams are closed. The `out` and `err` sinks receive the output from stdout and
@@ -33,6 +51,10 @@ output from the previous call to `reproc_drain` one by one.
 When a stream is closed, its corresponding `sink` is called once with `size` set
 to zero.
 
+When both stdout and stderr have output available, both are read before waiting
+for more output. The stream that's read first alternates so neither stream can
+starve the other.
+
 Note that his function returns 0 instead of `REPROC_EPIPE` when both output
 streams of the child process are closed.
 
@@ -42,6 +64,29 @@ Actionable errors:
 REPROC_EXPORT int
 reproc_drain(reproc_t *process, reproc_sink out, reproc_sink err);
 
+/*!
+`reproc_drain` but also writes the input produced by `in` to the child process
+stdin while reading its output. Because stdin, stdout and stderr are serviced in
+the same event loop, the child process can't deadlock on a full output pipe
+while we're waiting to write its input, regardless of how much data flows in
+either direction.
+
+If the child process exits or closes its stdin before all of the input was
+written, the rest of the input is discarded. `SIGPIPE` is blocked while writing
+so this doesn't raise `SIGPIPE` on POSIX systems.
+
+`in` is never called if `options.input` was passed to `reproc_start` because
+stdin is closed once `options.input` has been written. `reproc_drain` is
+equivalent to `reproc_communicate` with `REPROC_SOURCE_NULL` as `in`.
+
+Actionable errors:
+- `REPROC_ETIMEDOUT`
+*/
+REPROC_EXPORT int reproc_communicate(reproc_t *process,
+                                     reproc_source in,
+                                     reproc_sink out,
+                                     reproc_sink err);
+
 /*!
 Appends the output of a process (stdout and stderr) to the value of `output`.
 `output` must point to either `NULL` or a NUL-terminated string.
@@ -69,6 +114,143 @@ REPROC_EXPORT reproc_sink reproc_sink_string(char **output);
 /*! Discards the output of a process. */
 REPROC_EXPORT reproc_sink reproc_sink_discard(void);
 
+/*! `reproc_sink` but `function` also receives the time at which the output
+was read in `timestamp`. */
+typedef struct reproc_timed_sink {
+  int (*function)(REPROC_STREAM stream,
+                  const uint8_t *buffer,
+                  size_t size,
+                  int64_t timestamp,
+                  void *context);
+  void *context;
+} reproc_timed_sink;
+
+/*!
+Returns a sink that forwards output to `sink` together with a timestamp taken
+from the clock returned by `reproc_now` right after the output was read. Pass
+the same timed sink to both `out` and `err` to reconstruct the order in which
+the child process produced output on stdout and stderr.
+
+`reproc_drain` reads from both stdout and stderr whenever both are ready, so
+the timestamps of the two streams interleave in the order the output was read.
+Output written to one stream shortly before output written to the other stream
+may still be read in the opposite order.
+
+`sink` must stay valid as long as the returned sink is used.
+*/
+REPROC_EXPORT reproc_sink reproc_sink_timed(const reproc_timed_sink *sink);
+
+/*!
+Context of `reproc_sink_tee`: the `size` sinks in `sinks`.
+
+The sink combinators below chain existing sinks. Their context is owned by the
+caller and has to stay valid as long as the returned sink is used. Combinators
+can be nested, for example to limit the output passed to one of the sinks of a
+tee.
+*/
+typedef struct reproc_tee {
+  const reproc_sink *sinks;
+  size_t size;
+} reproc_tee;
+
+/*! Returns a sink that forwards all output to each of the sinks of `tee` in
+order. Stops at the first sink that returns a non-zero value and returns that
+value. */
+REPROC_EXPORT reproc_sink reproc_sink_tee(reproc_tee *tee);
+
+/*! Context of `reproc_sink_filter`. `predicate` is called with the same
+arguments as a sink. */
+typedef struct reproc_filter {
+  bool (*predicate)(REPROC_STREAM stream,
+                    const uint8_t *buffer,
+                    size_t size,
+                    void *context);
+  void *context;
+  reproc_sink sink;
+} reproc_filter;
+
+/*! Returns a sink that forwards output to `filter->sink` only if
+`filter->predicate` returns true for it. */
+REPROC_EXPORT reproc_sink reproc_sink_filter(reproc_filter *filter);
+
+/*! Context of `reproc_sink_limit`. `forwarded` has to be zero initially. */
+typedef struct reproc_limiter {
+  size_t size;
+  reproc_sink sink;
+  size_t forwarded;
+} reproc_limiter;
+
+/*! Returns a sink that forwards the first `limiter->size` bytes of output to
+`limiter->sink` and discards the rest. Calls with an empty buffer are always
+forwarded so the sink still sees the initial call and the closing of each
+stream. */
+REPROC_EXPORT reproc_sink reproc_sink_limit(reproc_limiter *limiter);
+
+/*! Context of `reproc_sink_sample`. `every` must be larger than zero and
+`count` has to be zero initially. */
+typedef struct reproc_sampler {
+  size_t every;
+  reproc_sink sink;
+  size_t count;
+} reproc_sampler;
+
+/*! Returns a sink that forwards only every `sampler->every`-th chunk of output
+to `sampler->sink`, starting with the first one. Calls with an empty buffer are
+always forwarded and not counted. */
+REPROC_EXPORT reproc_sink reproc_sink_sample(reproc_sampler *sampler);
+
+/*! Returns the current time of a monotonic clock in nanoseconds. Only the
+difference between two timestamps is meaningful. */
+REPROC_EXPORT int64_t reproc_now(void);
+
+/*!
+Output captured by `reproc_sink_capture`.
+
+On POSIX systems, output is stored in an anonymous file (a memfd on Linux or an
+unlinked temporary file elsewhere) that is mapped into memory and grown as
+necessary. Because the output lives in the page cache instead of on the heap,
+large outputs don't require reallocating and copying and can be shared with
+other processes via `reproc_capture_handle`. On Windows, output is stored on
+the heap.
+*/
+typedef struct reproc_capture reproc_capture;
+
+/*! Allocates a new capture. Returns `NULL` on failure. */
+REPROC_EXPORT reproc_capture *reproc_capture_new(void);
+
+/*!
+Appends the output of a process to `capture`. The same capture may be passed to
+both `out` and `err`.
+
+The sink returns `REPROC_EINVAL` once `reproc_capture_view` has been called.
+*/
+REPROC_EXPORT reproc_sink reproc_sink_capture(reproc_capture *capture);
+
+/*!
+Stops `capture` from growing any further and stores a read-only view of the
+captured output in `data` and `size`. `data` remains valid until `capture` is
+destroyed. `data` is `NULL` if no output was captured.
+
+On Linux, the underlying memfd is sealed so neither we nor other processes can
+modify it anymore.
+*/
+REPROC_EXPORT int reproc_capture_view(reproc_capture *capture,
+                                      const uint8_t **data,
+                                      size_t *size);
+
+/*!
+Returns the file that backs `capture`. After calling `reproc_capture_view`,
+the file contains exactly the captured output. Pass it to another process (for
+example via `redirect.in` or `input.file`) to share the output without copying
+it. The handle is owned by `capture`.
+
+On Windows, this function returns `NULL`.
+*/
+REPROC_EXPORT reproc_handle reproc_capture_handle(reproc_capture *capture);
+
+/*! Releases the resources of `capture`. Always returns `NULL`. */
+REPROC_EXPORT reproc_capture *reproc_capture_destroy(reproc_capture *capture);
+
 /*! Calls `free` on `ptr` and returns `NULL`. Use this function to free memory
 allocated by `reproc_sink_string`. This avoids issues with allocating across
 module (DLL) boundaries on Windows. */
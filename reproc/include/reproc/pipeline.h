@@ -0,0 +1,66 @@
+#pragma once
+
+#include <reproc/reproc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+Starts `size` processes as a pipeline (`a | b | c`). The stdout of each process
+is connected directly to the stdin of the next process via a pipe, so data
+flows between the processes without passing through the parent process.
+
+`processes` must contain `size` processes allocated with `reproc_new` that
+haven't been started yet. `argv` and `options` contain the arguments and options
+of each process. `options` may be `NULL` to start every process with the default
+options.
+
+The stdin of the first process and the stdout of the last process are
+redirected as specified in their options. Drain the last process with
+`reproc_drain` to read the output of the pipeline. `redirect.in` and `input`
+may only be set for the first process. `redirect.out` may only be set for the
+last process. stderr of every process is redirected as specified in its options
+and goes to the parent's stderr by default.
+
+`redirect.parent`, `redirect.discard`, `redirect.file` and `redirect.path` only
+apply to the streams that aren't connected to another process in the pipeline.
+
+If a process fails to start, the processes before it have already been started.
+Call `reproc_destroy` on all processes as usual to stop them.
+
+Actionable errors:
+- `REPROC_EINVAL`
+*/
+REPROC_EXPORT int reproc_pipeline_start(reproc_t **processes,
+                                        const char *const *const *argv,
+                                        const reproc_options *options,
+                                        size_t size);
+
+/*!
+Calls `reproc_wait` on every process in the pipeline. `timeout` applies to the
+pipeline as a whole.
+
+Like `set -o pipefail` in a shell, returns the exit status of the last process
+that exited with a non-zero exit status or 0 if all processes exited
+successfully.
+
+Actionable errors:
+- `REPROC_ETIMEDOUT`
+*/
+REPROC_EXPORT int
+reproc_pipeline_wait(reproc_t **processes, size_t size, int timeout);
+
+/*!
+Calls `reproc_stop` with `stop` on every process in the pipeline, starting with
+the first process so later processes see their stdin closed.
+
+Returns the same exit status as `reproc_pipeline_wait`.
+*/
+REPROC_EXPORT int reproc_pipeline_stop(reproc_t **processes,
+                                       size_t size,
+                                       reproc_stop_actions stop);
+
+#ifdef __cplusplus
+}
+#endif
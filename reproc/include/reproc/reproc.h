@@ -41,6 +41,9 @@ REPROC_EXPORT extern const int REPROC_INFINITE;
 expires. */
 REPROC_EXPORT extern const int REPROC_DEADLINE;
 
+/*! Tells `reproc_start` to not limit a resource. See `reproc_limit`. */
+REPROC_EXPORT extern const uint64_t REPROC_LIMIT_INFINITY;
+
 /*! Stream identifiers used to indicate which stream to act on. */
 typedef enum {
   /*! stdin */
@@ -70,6 +73,32 @@ typedef enum {
   REPROC_REDIRECT_FILE,
   /*! Redirect to a specific path. */
   REPROC_REDIRECT_PATH,
+  /*!
+  Redirect to a `socketpair` instead of a pipe. `reproc_read`, `reproc_write`
+  and `reproc_poll` work exactly like they do for pipes. If both `in` and `out`
+  are redirected to a socket, they share a single socket so the child process
+  can use one bidirectional connection for both. See `socket` in
+  `reproc_redirect` for the available options.
+
+  Not supported on Windows, where pipes are sockets already.
+  */
+  REPROC_REDIRECT_SOCKET,
+  /*!
+  Redirect to a pseudo-terminal. Most programs only line buffer their output
+  when it's written to a terminal, so this makes output available as soon as a
+  line is written instead of whenever the program's stdio buffer fills up.
+  `reproc_read`, `reproc_poll` and `reproc_drain` work exactly like they do for
+  pipes. Only valid for stdout and stderr. If both are redirected to a
+  pseudo-terminal, they share a single one and all output is read from
+  `REPROC_STREAM_OUT`. See `pty` in `reproc_redirect` for the available options.
+
+  The terminal doesn't translate newlines so the output is identical to the
+  output written to a pipe. Because stdin isn't part of the terminal, nothing
+  is echoed.
+
+  Not supported on Windows.
+  */
+  REPROC_REDIRECT_PTY,
 } REPROC_REDIRECT;
 
 /*! Used to tell `reproc_stop` how to stop a child process. */
@@ -82,6 +111,15 @@ typedef enum {
   REPROC_STOP_TERMINATE,
   /*! `reproc_kill` */
   REPROC_STOP_KILL,
+  /*!
+  (Linux) Kill every process in the cgroup of the child process (see the
+  `cgroup` option) using `cgroup.kill`. Unlike `REPROC_STOP_KILL`, this also
+  kills the descendants of the child process. If the child process exits
+  during an earlier action, the cgroup is still killed afterwards (and by
+  `reproc_destroy` if the child process was already waited for). Behaves like
+  `REPROC_STOP_KILL` if the child process wasn't placed in a cgroup.
+  */
+  REPROC_STOP_KILL_CGROUP,
 } REPROC_STOP;
 
 typedef struct reproc_stop_action {
@@ -155,13 +193,188 @@ typedef struct reproc_redirect {
   `handle`, `file` must be unset.
   */
   const char *path;
+  /*!
+  Options for `REPROC_REDIRECT_SOCKET`.
+
+  If any of these options is set, `type` must be unset or set to
+  `REPROC_REDIRECT_SOCKET` and `handle`, `file`, `path` must be unset. If `in`
+  and `out` share a socket, their socket options must be identical.
+  */
+  struct {
+    /*!
+    Use `SOCK_SEQPACKET` instead of `SOCK_STREAM`. Every write is delivered as
+    a separate message and every read returns at most one message. Bytes of a
+    message that don't fit in the buffer passed to `reproc_read` are discarded.
+    Empty messages are indistinguishable from the socket being closed.
+    */
+    bool seqpacket;
+    /*!
+    Size in bytes of the send and receive buffers of both ends of the socket
+    (`SO_SNDBUF` and `SO_RCVBUF`). When zero, the system default is used.
+    */
+    int buffer;
+  } socket;
+  /*!
+  Options for `REPROC_REDIRECT_PTY`.
+
+  If any of these options is set, `type` must be unset or set to
+  `REPROC_REDIRECT_PTY` and `handle`, `file`, `path` must be unset. If `out` and
+  `err` share a pseudo-terminal, their options must be identical.
+  */
+  struct {
+    /*! Window size of the terminal. When zero, 24 rows and 80 columns are
+    used. */
+    int rows;
+    int columns;
+    /*!
+    Make the terminal the controlling terminal of the child process. This
+    starts the child process in a new session, just like `session` in
+    `reproc_options` does. The child process can then open `/dev/tty` and
+    receives `SIGHUP` once the terminal is closed.
+    */
+    bool controlling;
+  } pty;
 } reproc_redirect;
 
+/*! Maximum amount of extra file descriptors passed to a child process. */
+enum { REPROC_EXTRA_FDS_MAX = 4 };
+
+/*! An extra file descriptor passed to the child process in addition to its
+standard streams. POSIX only. */
+typedef struct reproc_extra_fd {
+  /*! File descriptor number in the child process, for example 3 for
+  `--status-fd=3`. Must be larger than 2. Entries where `fd` is zero are
+  unused. */
+  int fd;
+  /*!
+  If true, the child process reads from `fd` and the parent process writes to
+  it using `reproc_write_extra`. Otherwise, the child process writes to `fd`
+  and the parent process reads from it using `reproc_read_extra`.
+  */
+  bool input;
+  /*!
+  Pass a handle to the child process as `fd` instead of creating a new pipe.
+  Just like with `redirect.handle`, reproc does not take ownership of the
+  handle. `input` is ignored when `handle` is set.
+  */
+  reproc_handle handle;
+} reproc_extra_fd;
+
 typedef enum {
   REPROC_ENV_EXTEND,
   REPROC_ENV_EMPTY,
 } REPROC_ENV;
 
+/*! Soft and hard limit of a resource. See `setrlimit`. */
+typedef struct reproc_limit {
+  /*! The limit is only applied if `set` is true. Otherwise, the child process
+  inherits the limit of the parent process. */
+  bool set;
+  /*! Limit enforced by the kernel. Must not exceed `hard`. */
+  uint64_t soft;
+  /*! Ceiling for `soft`. Raising the hard limit requires privileges. */
+  uint64_t hard;
+} reproc_limit;
+
+typedef struct reproc_limits {
+  /*! Maximum size of the virtual memory of the process in bytes. */
+  reproc_limit as;
+  /*! Maximum amount of CPU time in seconds. */
+  reproc_limit cpu;
+  /*! Maximum file descriptor number plus one. */
+  reproc_limit nofile;
+  /*! Maximum amount of processes of the real user ID of the process. */
+  reproc_limit nproc;
+  /*! Maximum size of core dumps in bytes. */
+  reproc_limit core;
+  /*! Maximum size of files created by the process in bytes. */
+  reproc_limit fsize;
+} reproc_limits;
+
+/*! Scheduling policy of the child process. See `sched_setscheduler`. */
+typedef enum {
+  /*! Inherit the scheduling policy of the parent process. */
+  REPROC_SCHED_INHERIT,
+  REPROC_SCHED_OTHER,
+  REPROC_SCHED_BATCH,
+  REPROC_SCHED_IDLE,
+  REPROC_SCHED_FIFO,
+  REPROC_SCHED_RR,
+} REPROC_SCHED;
+
+/*! NUMA memory policy of the child process. See `set_mempolicy`. */
+typedef enum {
+  /*! Inherit the memory policy of the parent process. */
+  REPROC_MEMPOLICY_INHERIT,
+  /*! Use the system default policy. */
+  REPROC_MEMPOLICY_DEFAULT,
+  /*! Only allocate memory on the given nodes. */
+  REPROC_MEMPOLICY_BIND,
+  /*! Interleave allocations over the given nodes. */
+  REPROC_MEMPOLICY_INTERLEAVE,
+  /*! Prefer allocating memory on the given node. */
+  REPROC_MEMPOLICY_PREFERRED,
+  /*! Allocate memory on the node of the CPU that triggered the allocation. */
+  REPROC_MEMPOLICY_LOCAL,
+} REPROC_MEMPOLICY;
+
+/*! I/O scheduling class of the child process. See `ioprio_set`. */
+typedef enum {
+  /*! Inherit the I/O priority of the parent process. */
+  REPROC_IOPRIO_INHERIT,
+  REPROC_IOPRIO_REALTIME,
+  REPROC_IOPRIO_BEST_EFFORT,
+  REPROC_IOPRIO_IDLE,
+} REPROC_IOPRIO;
+
+typedef struct reproc_scheduling {
+  /*! CPUs the child process is allowed to run on. If `size` is 0, the child
+  process inherits the CPU affinity of the parent process. */
+  struct {
+    const int *cpus;
+    size_t size;
+  } affinity;
+  /*! NUMA memory policy and the nodes it applies to. */
+  struct {
+    REPROC_MEMPOLICY policy;
+    const int *nodes;
+    size_t size;
+  } memory;
+  /*! Nice value between -20 and 19. Only applied if `set` is true. */
+  struct {
+    bool set;
+    int value;
+  } nice;
+  /*! Scheduling policy. `priority` must be between 1 and 99 for
+  `REPROC_SCHED_FIFO` and `REPROC_SCHED_RR` and 0 otherwise. */
+  struct {
+    REPROC_SCHED policy;
+    int priority;
+  } cpu;
+  /*! I/O scheduling class. `level` must be between 0 (highest) and 7 (lowest)
+  and is ignored for `REPROC_IOPRIO_IDLE`. */
+  struct {
+    REPROC_IOPRIO type;
+    int level;
+  } io;
+} reproc_scheduling;
+
+/*! See the `cgroup` option. A limit of zero leaves the cgroup's current limit
+untouched. `REPROC_LIMIT_INFINITY` removes the limit. */
+typedef struct reproc_cgroup {
+  /*! Path of a cgroup v2 directory. It's created if it doesn't exist yet. */
+  const char *path;
+  /*! Written to `memory.max`. */
+  uint64_t memory_max;
+  /*! Written to `cpu.max`. `period` defaults to 100000 microseconds. */
+  struct {
+    uint64_t quota;
+    uint64_t period;
+  } cpu_max;
+  /*! Written to `pids.max`. */
+  uint64_t pids_max;
+} reproc_cgroup;
+
 typedef struct reproc_options {
   /*!
   `working_directory` specifies the working directory for the child process. If
@@ -240,6 +453,20 @@ typedef struct reproc_options {
     const char *path;
   } redirect;
   /*!
+  Extra file descriptors passed to the child process, for side channels such as
+  structured results or progress events that shouldn't be mixed with stdout.
+  Each entry is either a new pipe that is polled with `REPROC_EVENT_EXTRA` and
+  used with `reproc_read_extra`, `reproc_write_extra` and `reproc_close_extra`,
+  or a handle from the parent process. Pipes are put in nonblocking mode if
+  `nonblocking` is enabled.
+
+  Every `fd` may only be used once. Extra file descriptors can't be combined
+  with `fork`.
+
+  If any extra file descriptor is set on Windows, an error is returned.
+  */
+  reproc_extra_fd extra_fds[REPROC_EXTRA_FDS_MAX];
+  /*!
   Stop actions that are passed to `reproc_stop` in `reproc_destroy` to stop the
   child process. See `reproc_stop` for more information on how `stop` is
   interpreted.
@@ -263,18 +490,55 @@ typedef struct reproc_options {
   */
   int deadline;
   /*!
-  `input` is written to the stdin pipe before the child process is started.
-
-  Because `input` is written to the stdin pipe before the process starts,
-  `input.size` must be smaller than the system's default pipe size (64KB).
+  `input` is written to the stdin pipe of the child process. As much of `input`
+  as fits in the stdin pipe is written before the child process is started.
+  The rest is written while the child process is running as part of
+  `reproc_poll`, `reproc_read` and `reproc_wait`, interleaved with reading its
+  output, so `input` can be of any size. No input is written while none of
+  these are called. If `input` doesn't fit in the stdin pipe, `input.data` has
+  to stay valid until all of it has been written.
+
+  If the child process exits without reading all of `input`, the rest is
+  discarded. On POSIX systems, `SIGPIPE` is blocked in the calling thread while
+  `input` is written so this doesn't kill the parent process, even if it
+  doesn't ignore `SIGPIPE`.
 
   If `input` is set, the stdin pipe is closed after `input` is written to it.
+  Until then, `reproc_write` returns `REPROC_EPIPE`.
 
   If `redirect.in` is set, this option may not be set.
+
+  Instead of `data`, `file` can be used to stream stdin from a file. Set either
+  `file.handle` or `file.path`. The child process receives `file.length` bytes
+  starting at `file.offset`, or everything from `file.offset` to the end of the
+  file if `file.length` is zero.
+
+  If `file.length` is zero, reproc passes the file to the child process as its
+  stdin directly when it can. This is the case if `file.path` is used, or if
+  `file.handle` is used and `file.offset` is zero. In the latter case, the child
+  process reads from the current position of `file.handle`. In all other cases,
+  the current position of `file.handle` is ignored.
+
+  Otherwise, the file is streamed to the stdin pipe in the same way as `data`.
+  On Linux, `splice` moves the data without copying it to user space.
+  `file.handle` is duplicated so it can be closed after `reproc_start` returns.
+
+  (POSIX) If `memfd` is enabled, `data` is copied into a sealed anonymous file
+  (see `reproc_memfd`) which is passed to the child process as its stdin
+  instead of a pipe. The child process can then read or map its input at its
+  own pace without any involvement from the parent process. If enabled on
+  Windows, an error will be returned.
   */
   struct {
     const uint8_t *data;
     size_t size;
+    struct {
+      reproc_handle handle;
+      const char *path;
+      uint64_t offset;
+      uint64_t length;
+    } file;
+    bool memfd;
   } input;
   /*!
   This option can only be used on POSIX systems. If enabled on Windows, an error
@@ -294,6 +558,103 @@ typedef struct reproc_options {
   until streams becomes readable/writable.
   */
   bool nonblocking;
+  /*!
+  (POSIX) Start the child process in a new process group or, if `session` is
+  enabled, in a new session. `reproc_terminate`, `reproc_kill` and the
+  corresponding stop actions then signal the entire process group instead of
+  only the child process so descendants that stayed in the group are stopped as
+  well. Descendants are still signaled after the child process itself exited,
+  but only until it has been reaped by `reproc_wait` (or the reaper, see
+  `reproc_reaper_start`). Afterwards, the process group ID might be reused so
+  nothing is signaled anymore. If the child process exits during one of the
+  actions passed to `reproc_stop`, the remaining actions are applied to the
+  process group right away before the child process is reaped. Otherwise, to
+  stop descendants that outlive the child process, signal the group before
+  calling `reproc_wait` or use a cgroup with `REPROC_STOP_KILL_CGROUP`.
+
+  On Linux, the exit of the child process is tracked independently of its
+  descendants. Once the child process has exited, `reproc_poll` treats its
+  output streams as closed as soon as they have no more output available, even
+  if a descendant inherited them. This keeps `reproc_drain` from waiting for
+  descendants that outlive the child process. On other POSIX systems, the
+  output streams are only closed once every descendant that inherited them has
+  closed them, so `reproc_drain` keeps waiting for those descendants.
+
+  These options are ignored on Windows where child processes are always started
+  in a new process group.
+  */
+  bool process_group;
+  bool session;
+  /*!
+  (POSIX) Unless `disable` is set, `reproc_start` searches PATH for the program
+  in `argv[0]` itself and caches the result so that the child process only has
+  to call `exec` once. Cached results are reused by later calls to
+  `reproc_start` with the same program and PATH as long as none of the searched
+  directories have been modified since. Only PATHs that consist of absolute
+  directories are cached. Use `reproc_path_cache_stats` to inspect how
+  effective the cache is.
+
+  This option is ignored on Windows.
+  */
+  struct {
+    bool disable;
+  } path_cache;
+  /*!
+  (POSIX) Resource limits applied in the child process right before `exec` is
+  called. Exceeding a limit makes the corresponding system call fail or, for
+  `cpu` and `fsize`, sends a signal to the child process. If a limit can't be
+  applied, `reproc_start` fails with the error from `setrlimit`.
+
+  Use `REPROC_LIMIT_INFINITY` to remove a limit. Limits that aren't supported
+  by the system are ignored.
+
+  If any limit is set on Windows, an error will be returned.
+  */
+  reproc_limits limits;
+  /*!
+  (Linux) Scheduling parameters applied in the child process right before
+  `exec` is called. Setting the memory policy, the CPU affinity or the I/O
+  priority doesn't require any privileges. Raising the priority of the child
+  process above that of the parent process usually does. If a parameter can't
+  be applied, `reproc_start` fails with the error of the corresponding system
+  call.
+
+  The nice value is supported on all POSIX systems. If any other parameter is
+  set on other POSIX systems or if any parameter is set on Windows, an error
+  will be returned.
+  */
+  reproc_scheduling scheduling;
+  /*!
+  (Linux) If `cgroup.path` is set, the child process moves itself into that
+  cgroup v2 directory before calling `exec` so every process it starts is part
+  of the cgroup as well. The limits in `cgroup` are applied to the cgroup before
+  the child process is started. reproc doesn't remove the cgroup directory
+  afterwards.
+
+  Use `REPROC_STOP_KILL_CGROUP` to reliably stop the child process together
+  with all of its descendants and `reproc_rusage` to read the cgroup's
+  statistics after the child process exits.
+
+  If `cgroup.path` is set on other platforms, an error will be returned.
+  */
+  reproc_cgroup cgroup;
+  /*!
+  Shared-memory ring the child process can write records to without copying
+  them through a pipe. See reproc/ring.h.
+  */
+  struct {
+    /*!
+    Size of the ring in bytes, rounded up to a power of two of at least 4096.
+    If zero, no ring is created.
+
+    The ring is passed to the child process as two extra file descriptors (the
+    lowest ones not used by `extra_fds`) that are named in the `REPROC_RING`
+    environment variable. A ring can't be combined with `fork`.
+
+    If `size` is set on Windows, an error is returned.
+    */
+    size_t size;
+  } ring;
 } reproc_options;
 
 enum {
@@ -308,8 +669,61 @@ enum {
   /*! The deadline of the process expired. This event is added by default to the
   list of interested events. */
   REPROC_EVENT_DEADLINE = 1 << 4,
+  /*! The pipe of `extra_fds[0]` can be read from or written to (if `input` is
+  set). The events of `extra_fds[i]` are `REPROC_EVENT_EXTRA << i`. */
+  REPROC_EVENT_EXTRA = 1 << 5,
+  /*! A record can be read from the ring with `reproc_ring_read` or the child
+  process closed its end of the ring. See reproc/ring.h. */
+  REPROC_EVENT_RING = 1 << 9,
 };
 
+/*! Statistics of the executable lookup cache used by `reproc_start`. */
+typedef struct reproc_cache_stats {
+  /*! Amount of lookups answered by the cache. */
+  size_t hits;
+  /*! Amount of lookups that had to search PATH. */
+  size_t misses;
+} reproc_cache_stats;
+
+/*!
+Resources used by a child process over its lifetime. Fields that aren't
+available on the current platform are zero.
+*/
+typedef struct reproc_usage {
+  /*! CPU time spent in user mode in microseconds. */
+  int64_t utime;
+  /*! CPU time spent in kernel mode in microseconds. */
+  int64_t stime;
+  /*! Peak resident set size (peak working set size on Windows) in bytes. */
+  int64_t maxrss;
+  /*! Page faults that required I/O. (POSIX) */
+  int64_t majflt;
+  /*! Voluntary context switches. (POSIX) */
+  int64_t nvcsw;
+  /*! Involuntary context switches. (POSIX) */
+  int64_t nivcsw;
+  /*! Block input operations (read operations on Windows). */
+  int64_t inblock;
+  /*! Block output operations (write operations on Windows). */
+  int64_t oublock;
+  /*!
+  (Linux) Statistics of the cgroup the child process was placed in with the
+  `cgroup` option, read from `cpu.stat` and `memory.peak`. Unlike the fields
+  above, these include every process that ever ran in the cgroup.
+  */
+  struct {
+    /*! Total CPU time in microseconds. */
+    int64_t usage;
+    /*! CPU time spent in user mode in microseconds. */
+    int64_t user;
+    /*! CPU time spent in kernel mode in microseconds. */
+    int64_t system;
+    /*! Peak memory usage in bytes. Requires Linux 5.19 and the memory
+    controller. */
+    int64_t memory_peak;
+  } cgroup;
+} reproc_usage;
+
 typedef struct reproc_event_source {
   /*! Process to poll for events. */
   reproc_t *process;
@@ -425,9 +839,68 @@ Closes the child process standard stream indicated by `stream`.
 This function is necessary when a child process reads from stdin until it is
 closed. After writing all the input to the child process using `reproc_write`,
 the standard input stream can be closed using this function.
+
+If stdin and stdout share a socket (see `REPROC_REDIRECT_SOCKET`), closing stdin
+shuts down the sending side of the socket so the child process reads end of
+file while its output can still be read.
 */
 REPROC_EXPORT int reproc_close(reproc_t *process, REPROC_STREAM stream);
 
+/*!
+`reproc_read` for the pipe of `extra_fds[index]`. The child process must write
+to the pipe (`input` unset).
+*/
+REPROC_EXPORT int reproc_read_extra(reproc_t *process,
+                                    size_t index,
+                                    uint8_t *buffer,
+                                    size_t size);
+
+/*!
+`reproc_write` for the pipe of `extra_fds[index]`. The child process must read
+from the pipe (`input` set).
+*/
+REPROC_EXPORT int reproc_write_extra(reproc_t *process,
+                                     size_t index,
+                                     const uint8_t *buffer,
+                                     size_t size);
+
+/*! `reproc_close` for the pipe of `extra_fds[index]`. */
+REPROC_EXPORT int reproc_close_extra(reproc_t *process, size_t index);
+
+/*!
+Writes everything `source` writes to `stream` (`REPROC_STREAM_OUT` or
+`REPROC_STREAM_ERR`) to the stdin of every process in `targets` until `source`
+closes `stream`, after which the stdin of every target is closed.
+
+Data that has been read from `source` is kept until every target has received
+it. `limit` bounds the amount of data kept (64KB if zero), which also bounds how
+far the fastest target can get ahead of the slowest one. Once the limit is
+reached, no more data is read from `source` until the slowest target catches
+up. Targets that close their stdin are skipped from then on.
+
+On Linux, whenever all targets are caught up, data is duplicated from the
+output pipe of `source` to the stdin pipes of all targets but the last with
+`tee` and moved to the stdin pipe of the last target with `splice`, so it's
+never copied to user space. Only if a target can't take all of the data
+immediately is it copied to user space so it can be written to that target
+later.
+
+This function doesn't read the output of the targets. Redirect it to a file or
+read it from another thread to keep the targets from blocking on a full output
+pipe. Targets that exit are skipped as well. `SIGPIPE` is blocked while writing
+so this doesn't raise `SIGPIPE` on POSIX systems.
+
+`options.input` may not be used for any of the targets.
+
+Actionable errors:
+- `REPROC_ETIMEDOUT`: The deadline of one of the processes expired.
+*/
+REPROC_EXPORT int reproc_fanout(reproc_t *source,
+                                REPROC_STREAM stream,
+                                reproc_t **targets,
+                                size_t num_targets,
+                                size_t limit);
+
 /*!
 Waits `timeout` milliseconds for the child process to exit. If the child process
 has already exited or exits within the given timeout, its exit status is
@@ -446,7 +919,9 @@ REPROC_EXPORT int reproc_wait(reproc_t *process, int timeout);
 
 /*!
 Sends the `SIGTERM` signal (POSIX) or the `CTRL-BREAK` signal (Windows) to the
-child process. Remember that successful calls to `reproc_wait` and
+child process. If `process_group` or `session` was enabled, the signal is sent
+to the child process's process group instead. Does nothing once the child
+process has been reaped. Remember that successful calls to `reproc_wait` and
 `reproc_destroy` are required to make sure the child process is completely
 cleaned up.
 */
@@ -454,9 +929,11 @@ REPROC_EXPORT int reproc_terminate(reproc_t *process);
 
 /*!
 Sends the `SIGKILL` signal to the child process (POSIX) or calls
-`TerminateProcess` (Windows) on the child process. Remember that successful
-calls to `reproc_wait` and `reproc_destroy` are required to make sure the child
-process is completely cleaned up.
+`TerminateProcess` (Windows) on the child process. If `process_group` or
+`session` was enabled, `SIGKILL` is sent to the child process's process group
+instead. Does nothing once the child process has been reaped. Remember that
+successful calls to `reproc_wait` and `reproc_destroy` are required to make sure
+the child process is completely cleaned up.
 */
 REPROC_EXPORT int reproc_kill(reproc_t *process);
 
@@ -505,6 +982,17 @@ Actionable errors:
 */
 REPROC_EXPORT int reproc_stop(reproc_t *process, reproc_stop_actions stop);
 
+/*!
+Stores the resources used by the child process in `usage`. The usage is
+collected when the child process is cleaned up so this function only succeeds
+after `reproc_wait` or `reproc_stop` returned the exit status of the child
+process.
+
+Actionable errors:
+- `REPROC_EINVAL`: The child process hasn't exited yet.
+*/
+REPROC_EXPORT int reproc_rusage(reproc_t *process, reproc_usage *usage);
+
 /*!
 Release all resources associated with `process` including the memory allocated
 by `reproc_new`. Calling this function before a succesfull call to `reproc_wait`
@@ -519,6 +1007,68 @@ Example: `process = reproc_destroy(process)`.
 */
 REPROC_EXPORT reproc_t *reproc_destroy(reproc_t *process);
 
+/*!
+Returns the statistics of the process-wide executable lookup cache. See the
+`path_cache` option for more information.
+*/
+REPROC_EXPORT reproc_cache_stats reproc_path_cache_stats(void);
+
+/*!
+Enables the process-wide reaper. Child processes started after calling this
+function are tracked by the reaper so they can be reaped as soon as they exit
+instead of lingering as zombies until `reproc_wait` is called. This includes
+child processes whose `reproc_t` instance was destroyed before they exited, for
+example because the stop actions passed to `reproc_destroy` didn't wait for
+them to exit.
+
+If `thread` is true, a background thread reaps child processes as soon as they
+exit. Otherwise, call `reproc_reap` from the program's event loop, for example
+whenever `SIGCHLD` is received.
+
+The exit status and resource usage of a reaped child process are kept until
+`reproc_wait` is called on its `reproc_t` instance, which then returns
+immediately.
+
+On Windows, exited child processes are cleaned up by `reproc_destroy` and this
+function does nothing.
+
+If `thread` is true and reproc was built without `REPROC_MULTITHREADED`, an
+error will be returned.
+*/
+REPROC_EXPORT int reproc_reaper_start(bool thread);
+
+/*!
+Stops the background thread started by `reproc_reaper_start` and stops tracking
+new child processes. Child processes that are already tracked can still be
+reaped with `reproc_reap`.
+*/
+REPROC_EXPORT int reproc_reaper_stop(void);
+
+/*!
+Reaps every tracked child process that has exited. If none has exited yet,
+waits up to `timeout` milliseconds for one to exit. This function might return
+before `timeout` expires without reaping any child processes.
+
+Returns the amount of child processes that were reaped.
+*/
+REPROC_EXPORT int reproc_reap(int timeout);
+
+/*!
+(POSIX) Copies `size` bytes from `data` into a new anonymous file and stores a
+handle to it in `handle`. On Linux, the file is a memfd that is sealed so it
+can't be modified anymore. Elsewhere, it's an unlinked temporary file. The
+caller has to close `handle` when it's no longer needed.
+
+To pass the same input to many child processes without copying it again, set
+`input.file.path` to `/proc/self/fd/<handle>` on Linux. Each child process then
+gets its own file position. Passing `handle` as `input.file.handle` instead
+makes all child processes share the position of `handle`.
+
+On Windows, an error is returned.
+*/
+REPROC_EXPORT int
+reproc_memfd(const uint8_t *data, size_t size, reproc_handle *handle);
+
 /*!
 Returns a string describing `error`. This string must not be modified by the
 caller.
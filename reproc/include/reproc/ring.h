@@ -0,0 +1,78 @@
+#pragma once
+
+#include <reproc/reproc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+A shared-memory ring that a child process writes records to without making a
+system call per record. The parent process creates the ring when
+`reproc_options.ring.size` is set and passes it to the child process via the
+`REPROC_RING` environment variable.
+
+Records are written by the child process with `reproc_ring_write` (or
+`reproc_ring_reserve` followed by `reproc_ring_commit` to build a record in
+place) and read by the parent process with `reproc_ring_read`. A record can be
+at most half the size of the ring. The ring has a single writer: only one thread
+of the child process may write to it at a time.
+
+Both sides only notify the other side over a socket when the other side is
+actually waiting: the parent process when it polls an empty ring and the child
+process when the ring is full.
+
+POSIX only.
+*/
+typedef struct reproc_ring reproc_ring;
+
+/*!
+Returns the next record written by the child process in `data` and `size`. The
+record is read directly from shared memory and stays valid until the next call
+to `reproc_ring_read`.
+
+If the ring is empty, this function blocks until the child process writes a
+record unless `nonblocking` was enabled in which case `REPROC_EWOULDBLOCK` is
+returned. Use `REPROC_EVENT_RING` with `reproc_poll` to wait until a record is
+available.
+
+Returns `REPROC_EPIPE` once the ring is empty and the child process (and every
+descendant that inherited the ring) closed its end of the ring. Returns
+`REPROC_EINVAL` if `process` wasn't started with a ring.
+*/
+REPROC_EXPORT int
+reproc_ring_read(reproc_t *process, const uint8_t **data, size_t *size);
+
+/*!
+Opens the ring passed by the parent process. Called by the child process.
+
+Returns `REPROC_EINVAL` if the parent process didn't pass a ring.
+*/
+REPROC_EXPORT int reproc_ring_open(reproc_ring **ring);
+
+/*!
+Reserves room for a record of up to `size` bytes and stores a pointer to it in
+`buffer`. If the ring is full, this function blocks until the parent process has
+read enough records.
+
+Returns `REPROC_EPIPE` if the parent process closed its end of the ring.
+*/
+REPROC_EXPORT int
+reproc_ring_reserve(reproc_ring *ring, size_t size, uint8_t **buffer);
+
+/*! Publishes the first `size` bytes of the record returned by the last call to
+`reproc_ring_reserve`. `size` may not exceed the reserved size. */
+REPROC_EXPORT int reproc_ring_commit(reproc_ring *ring, size_t size);
+
+/*! Copies `size` bytes from `data` into the ring as a single record. */
+REPROC_EXPORT int
+reproc_ring_write(reproc_ring *ring, const uint8_t *data, size_t size);
+
+/*! Closes the child process end of the ring. Once every record is read, the
+parent process gets `REPROC_EPIPE` from `reproc_ring_read`. Always returns
+`NULL`. */
+REPROC_EXPORT reproc_ring *reproc_ring_close(reproc_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
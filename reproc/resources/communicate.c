@@ -0,0 +1,23 @@
+#include <stdio.h>
+
+int main(int argc, const char **argv)
+{
+  char buffer[4096];
+  size_t size = 0;
+
+  (void) argv;
+
+  // Exit without reading stdin if we're passed any argument.
+  if (argc > 1) {
+    return 0;
+  }
+
+  // Echo stdin to stdout and stderr while it's still being written so the
+  // parent has to read our output before it can write all of its input.
+  while ((size = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
+    fwrite(buffer, 1, size, stdout);
+    fwrite(buffer, 1, size, stderr);
+  }
+
+  return 0;
+}
@@ -0,0 +1,17 @@
+#include <unistd.h>
+
+int main(void)
+{
+  char buffer[4096];
+  ssize_t size = 0;
+
+  // Copy everything written to fd 4 to fd 3 and fd 5.
+  while ((size = read(4, buffer, sizeof(buffer))) > 0) {
+    if (write(3, buffer, (size_t) size) != size ||
+        write(5, buffer, (size_t) size) != size) {
+      return 1;
+    }
+  }
+
+  return size < 0;
+}
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include <sys/resource.h>
+
+int main(void)
+{
+  struct rlimit nofile;
+  struct rlimit core;
+
+  if (getrlimit(RLIMIT_NOFILE, &nofile) < 0 ||
+      getrlimit(RLIMIT_CORE, &core) < 0) {
+    return 1;
+  }
+
+  printf("%llu %llu %llu", (unsigned long long) nofile.rlim_cur,
+         (unsigned long long) nofile.rlim_max,
+         (unsigned long long) core.rlim_cur);
+
+  return 0;
+}
@@ -0,0 +1,37 @@
+#include <reproc/ring.h>
+
+#include <stdlib.h>
+
+int main(int argc, const char **argv)
+{
+  (void) argc;
+
+  reproc_ring *ring = NULL;
+  int records = atoi(argv[1]);
+  uint8_t *buffer = NULL;
+
+  if (reproc_ring_open(&ring) < 0) {
+    return 1;
+  }
+
+  // Record `i` consists of `i % 301` bytes with value `i`.
+  for (int i = 0; i < records; i++) {
+    size_t size = (size_t) i % 301;
+
+    if (reproc_ring_reserve(ring, size, &buffer) < 0) {
+      return 1;
+    }
+
+    for (size_t j = 0; j < size; j++) {
+      buffer[j] = (uint8_t) i;
+    }
+
+    if (reproc_ring_commit(ring, size) < 0) {
+      return 1;
+    }
+  }
+
+  reproc_ring_close(ring);
+
+  return 0;
+}
@@ -0,0 +1,24 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIZE (64 * 1024 * 1024)
+
+int main(void)
+{
+  // Touch every page so they count towards the resident set size.
+  char *memory = malloc(SIZE);
+  if (memory == NULL) {
+    return EXIT_FAILURE;
+  }
+
+  memset(memory, 1, SIZE);
+
+  // Burn some CPU time.
+  while (clock() < CLOCKS_PER_SEC / 20) {
+  }
+
+  free(memory);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <string.h>
+
+enum { CHUNKS = 256, CHUNK_SIZE = 4096 };
+
+// Writes the same amount of output to stdout and stderr. The first stderr chunk
+// is written right after the first stdout chunk, while most of stdout still has
+// to be written. The rest of stderr follows once stdout is done.
+int main(void)
+{
+  char chunk[CHUNK_SIZE];
+  memset(chunk, 'x', sizeof(chunk));
+
+  for (int i = 0; i < CHUNKS; i++) {
+    fwrite(chunk, 1, sizeof(chunk), stdout);
+    fflush(stdout);
+
+    if (i == 0) {
+      fwrite(chunk, 1, sizeof(chunk), stderr);
+      fflush(stderr);
+    }
+  }
+
+  for (int i = 1; i < CHUNKS; i++) {
+    fwrite(chunk, 1, sizeof(chunk), stderr);
+    fflush(stderr);
+  }
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+#define _POSIX_C_SOURCE 200809L
+// `mremap` isn't part of POSIX.
+#define _GNU_SOURCE
+
+#include <reproc/drain.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "handle.h"
+#include "memfd.h"
+
+// The mapping grows to at least this size so small outputs don't have to be
+// remapped over and over again.
+enum { INITIAL_CAPACITY = 65536 };
+
+struct reproc_capture {
+  int file;
+  uint8_t *data;
+  size_t size;
+  // Size of both `file` and the mapping at `data`. Zero if `file` isn't
+  // mapped.
+  size_t capacity;
+  bool sealed;
+};
+
+reproc_capture *reproc_capture_new(void)
+{
+  reproc_capture *capture = malloc(sizeof(reproc_capture));
+  if (capture == NULL) {
+    return NULL;
+  }
+
+  *capture = (reproc_capture){ .file = HANDLE_INVALID };
+
+  int r = memfd_open(&capture->file);
+  if (r < 0) {
+    free(capture);
+    return NULL;
+  }
+
+  return capture;
+}
+
+static int capture_reserve(reproc_capture *capture, size_t size)
+{
+  if (size <= capture->capacity) {
+    return 0;
+  }
+
+  size_t capacity = capture->capacity == 0 ? INITIAL_CAPACITY
+                                           : capture->capacity;
+
+  while (capacity < size) {
+    if (capacity > SIZE_MAX / 2) {
+      return REPROC_ENOMEM;
+    }
+
+    capacity *= 2;
+  }
+
+  if (ftruncate(capture->file, (off_t) capacity) < 0) {
+    return -errno;
+  }
+
+  void *data = MAP_FAILED;
+
+#if defined(__linux__)
+  if (capture->data != NULL) {
+    data = mremap(capture->data, capture->capacity, capacity, MREMAP_MAYMOVE);
+  } else {
+    data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                capture->file, 0);
+  }
+#else
+  // Both mappings share the file's pages so there's nothing to copy.
+  data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, capture->file,
+              0);
+  if (data != MAP_FAILED && capture->data != NULL) {
+    munmap(capture->data, capture->capacity);
+  }
+#endif
+
+  if (data == MAP_FAILED) {
+    return -errno;
+  }
+
+  capture->data = data;
+  capture->capacity = capacity;
+
+  return 0;
+}
+
+static int sink_capture(REPROC_STREAM stream,
+                        const uint8_t *buffer,
+                        size_t size,
+                        void *context)
+{
+  (void) stream;
+
+  reproc_capture *capture = (reproc_capture *) context;
+  int r = -1;
+
+  if (capture->sealed) {
+    return REPROC_EINVAL;
+  }
+
+  if (size > SIZE_MAX - capture->size) {
+    return REPROC_ENOMEM;
+  }
+
+  r = capture_reserve(capture, capture->size + size);
+  if (r < 0) {
+    return r;
+  }
+
+  if (size > 0) {
+    memcpy(capture->data + capture->size, buffer, size);
+    capture->size += size;
+  }
+
+  return 0;
+}
+
+reproc_sink reproc_sink_capture(reproc_capture *capture)
+{
+  return (reproc_sink){ sink_capture, capture };
+}
+
+static int capture_seal(reproc_capture *capture)
+{
+  void *data = NULL;
+  int r = -1;
+
+  // Unlike a writable one, a private read-only mapping doesn't keep us from
+  // sealing the file.
+  if (capture->size > 0) {
+    data = mmap(NULL, capture->size, PROT_READ, MAP_PRIVATE, capture->file, 0);
+    if (data == MAP_FAILED) {
+      return -errno;
+    }
+  }
+
+  // The writable mapping has to go before we can seal the file. If sealing
+  // fails, the capture stays writable and the next write maps the file again.
+  if (capture->data != NULL) {
+    munmap(capture->data, capture->capacity);
+  }
+
+  capture->data = NULL;
+  capture->capacity = 0;
+
+  if (ftruncate(capture->file, (off_t) capture->size) < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = memfd_seal(capture->file);
+  if (r < 0) {
+    goto finish;
+  }
+
+  capture->data = data;
+  capture->capacity = capture->size;
+  capture->sealed = true;
+
+finish:
+  if (r < 0 && data != NULL) {
+    munmap(data, capture->size);
+  }
+
+  return r;
+}
+
+int reproc_capture_view(reproc_capture *capture,
+                        const uint8_t **data,
+                        size_t *size)
+{
+  ASSERT_EINVAL(capture);
+  ASSERT_EINVAL(data);
+  ASSERT_EINVAL(size);
+
+  if (!capture->sealed) {
+    int r = capture_seal(capture);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  *data = capture->data;
+  *size = capture->size;
+
+  return 0;
+}
+
+int reproc_capture_handle(reproc_capture *capture)
+{
+  ASSERT_RETURN(capture, HANDLE_INVALID);
+
+  return capture->file;
+}
+
+reproc_capture *reproc_capture_destroy(reproc_capture *capture)
+{
+  ASSERT_RETURN(capture, NULL);
+
+  if (capture->data != NULL) {
+    munmap(capture->data, capture->capacity);
+  }
+
+  handle_destroy(capture->file);
+  free(capture);
+
+  return NULL;
+}
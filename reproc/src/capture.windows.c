@@ -0,0 +1,133 @@
+#ifndef _WIN32_WINNT
+  #define _WIN32_WINNT 0x0600 // _WIN32_WINNT_VISTA
+#elif _WIN32_WINNT < 0x0600
+  #error "_WIN32_WINNT must be greater than _WIN32_WINNT_VISTA (0x0600)"
+#endif
+
+#include <reproc/drain.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "error.h"
+
+// The buffer grows to at least this size so small outputs don't have to be
+// reallocated over and over again.
+enum { INITIAL_CAPACITY = 65536 };
+
+struct reproc_capture {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+  bool sealed;
+};
+
+reproc_capture *reproc_capture_new(void)
+{
+  reproc_capture *capture = malloc(sizeof(reproc_capture));
+  if (capture == NULL) {
+    return NULL;
+  }
+
+  *capture = (reproc_capture){ 0 };
+
+  return capture;
+}
+
+static int capture_reserve(reproc_capture *capture, size_t size)
+{
+  if (size <= capture->capacity) {
+    return 0;
+  }
+
+  size_t capacity = capture->capacity == 0 ? INITIAL_CAPACITY
+                                           : capture->capacity;
+
+  while (capacity < size) {
+    if (capacity > SIZE_MAX / 2) {
+      return REPROC_ENOMEM;
+    }
+
+    capacity *= 2;
+  }
+
+  uint8_t *data = realloc(capture->data, capacity);
+  if (data == NULL) {
+    return REPROC_ENOMEM;
+  }
+
+  capture->data = data;
+  capture->capacity = capacity;
+
+  return 0;
+}
+
+static int sink_capture(REPROC_STREAM stream,
+                        const uint8_t *buffer,
+                        size_t size,
+                        void *context)
+{
+  (void) stream;
+
+  reproc_capture *capture = (reproc_capture *) context;
+  int r = -1;
+
+  if (capture->sealed) {
+    return REPROC_EINVAL;
+  }
+
+  if (size > SIZE_MAX - capture->size) {
+    return REPROC_ENOMEM;
+  }
+
+  r = capture_reserve(capture, capture->size + size);
+  if (r < 0) {
+    return r;
+  }
+
+  if (size > 0) {
+    memcpy(capture->data + capture->size, buffer, size);
+    capture->size += size;
+  }
+
+  return 0;
+}
+
+reproc_sink reproc_sink_capture(reproc_capture *capture)
+{
+  return (reproc_sink){ sink_capture, capture };
+}
+
+int reproc_capture_view(reproc_capture *capture,
+                        const uint8_t **data,
+                        size_t *size)
+{
+  ASSERT_EINVAL(capture);
+  ASSERT_EINVAL(data);
+  ASSERT_EINVAL(size);
+
+  capture->sealed = true;
+
+  *data = capture->size > 0 ? capture->data : NULL;
+  *size = capture->size;
+
+  return 0;
+}
+
+HANDLE reproc_capture_handle(reproc_capture *capture)
+{
+  (void) capture;
+  return NULL;
+}
+
+reproc_capture *reproc_capture_destroy(reproc_capture *capture)
+{
+  ASSERT_RETURN(capture, NULL);
+
+  free(capture->data);
+  free(capture);
+
+  return NULL;
+}
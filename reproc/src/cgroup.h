@@ -0,0 +1,28 @@
+#pragma once
+
+#include <reproc/reproc.h>
+
+// A file descriptor of a cgroup v2 directory.
+typedef int cgroup_type;
+
+extern const cgroup_type CGROUP_INVALID;
+
+// Opens the cgroup directory at `options.path`, creating it if it doesn't exist
+// yet, and writes the limits in `options` to its interface files. If
+// `options.path` is `NULL`, `cgroup` is set to `CGROUP_INVALID`.
+//
+// Linux only.
+int cgroup_open(reproc_cgroup options, cgroup_type *cgroup);
+
+// Moves the calling process into `cgroup`. Only uses async-signal-safe
+// functions so it can be called in the child process after forking.
+int cgroup_enter(cgroup_type cgroup);
+
+// Kills every process in `cgroup`.
+int cgroup_kill(cgroup_type cgroup);
+
+// Stores the CPU and memory statistics of `cgroup` in `usage`. Statistics that
+// aren't available are set to zero.
+int cgroup_stats(cgroup_type cgroup, reproc_usage *usage);
+
+cgroup_type cgroup_destroy(cgroup_type cgroup);
@@ -0,0 +1,242 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "cgroup.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "macro.h"
+
+const cgroup_type CGROUP_INVALID = -1;
+
+static int cgroup_write(cgroup_type cgroup, const char *file, const char *value)
+{
+  int fd = openat(cgroup, file, O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -errno;
+  }
+
+  size_t size = strlen(value);
+  ssize_t r = write(fd, value, size);
+  int error = errno;
+
+  close(fd);
+
+  if (r < 0) {
+    return -error;
+  }
+
+  return (size_t) r == size ? 0 : -EIO;
+}
+
+#if defined(__linux__)
+// Default period of `cpu.max` in microseconds.
+static const uint64_t CPU_PERIOD = 100000;
+
+static int cgroup_write_limit(cgroup_type cgroup,
+                              const char *file,
+                              uint64_t limit)
+{
+  char value[32];
+
+  if (limit == 0) {
+    return 0;
+  }
+
+  if (limit == REPROC_LIMIT_INFINITY) {
+    snprintf(value, sizeof(value), "max");
+  } else {
+    snprintf(value, sizeof(value), "%" PRIu64, limit);
+  }
+
+  return cgroup_write(cgroup, file, value);
+}
+#endif
+
+static FILE *cgroup_fopen(cgroup_type cgroup, const char *file)
+{
+  int fd = openat(cgroup, file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  FILE *stream = fdopen(fd, "r");
+  if (stream == NULL) {
+    close(fd);
+  }
+
+  return stream;
+}
+
+int cgroup_open(reproc_cgroup options, cgroup_type *cgroup)
+{
+  ASSERT(cgroup);
+
+  *cgroup = CGROUP_INVALID;
+
+  if (options.path == NULL) {
+    return 0;
+  }
+
+#if defined(__linux__)
+  cgroup_type fd = CGROUP_INVALID;
+  int r = -1;
+
+  r = mkdir(options.path, 0755);
+  if (r < 0 && errno != EEXIST) {
+    return -errno;
+  }
+
+  fd = open(options.path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return -errno;
+  }
+
+  r = cgroup_write_limit(fd, "memory.max", options.memory_max);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = cgroup_write_limit(fd, "pids.max", options.pids_max);
+  if (r < 0) {
+    goto finish;
+  }
+
+  if (options.cpu_max.quota != 0) {
+    uint64_t period = options.cpu_max.period == 0 ? CPU_PERIOD
+                                                  : options.cpu_max.period;
+    char value[64];
+
+    if (options.cpu_max.quota == REPROC_LIMIT_INFINITY) {
+      snprintf(value, sizeof(value), "max %" PRIu64, period);
+    } else {
+      snprintf(value, sizeof(value), "%" PRIu64 " %" PRIu64,
+               options.cpu_max.quota, period);
+    }
+
+    r = cgroup_write(fd, "cpu.max", value);
+    if (r < 0) {
+      goto finish;
+    }
+  }
+
+  *cgroup = fd;
+  fd = CGROUP_INVALID;
+
+finish:
+  if (fd != CGROUP_INVALID) {
+    close(fd);
+  }
+
+  return r;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+int cgroup_enter(cgroup_type cgroup)
+{
+  ASSERT(cgroup != CGROUP_INVALID);
+
+  // Writing 0 moves the writing process.
+  return cgroup_write(cgroup, "cgroup.procs", "0");
+}
+
+int cgroup_kill(cgroup_type cgroup)
+{
+  ASSERT(cgroup != CGROUP_INVALID);
+
+  int r = cgroup_write(cgroup, "cgroup.kill", "1");
+  if (r != -ENOENT) {
+    return r;
+  }
+
+  // `cgroup.kill` was added in Linux 5.14. On older kernels, we freeze the
+  // cgroup so its processes can't fork while we're killing them one by one.
+  // The killed processes exit as soon as the cgroup is thawed again.
+  bool frozen = cgroup_write(cgroup, "cgroup.freeze", "1") == 0;
+
+  FILE *procs = cgroup_fopen(cgroup, "cgroup.procs");
+  if (procs == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  int pid = 0;
+  r = 0;
+
+  while (fscanf(procs, "%d", &pid) == 1) {
+    if (kill(pid, SIGKILL) < 0 && errno != ESRCH) {
+      r = -errno;
+    }
+  }
+
+  fclose(procs);
+
+finish:
+  if (frozen) {
+    cgroup_write(cgroup, "cgroup.freeze", "0");
+  }
+
+  return r;
+}
+
+int cgroup_stats(cgroup_type cgroup, reproc_usage *usage)
+{
+  ASSERT(cgroup != CGROUP_INVALID);
+  ASSERT(usage);
+
+  FILE *stream = cgroup_fopen(cgroup, "cpu.stat");
+  if (stream == NULL) {
+    return -errno;
+  }
+
+  char key[64];
+  int64_t value = 0;
+
+  while (fscanf(stream, "%63s %" SCNd64, key, &value) == 2) {
+    if (strcmp(key, "usage_usec") == 0) {
+      usage->cgroup.usage = value;
+    } else if (strcmp(key, "user_usec") == 0) {
+      usage->cgroup.user = value;
+    } else if (strcmp(key, "system_usec") == 0) {
+      usage->cgroup.system = value;
+    }
+  }
+
+  fclose(stream);
+
+  // `memory.peak` was added in Linux 5.19 and requires the memory controller to
+  // be enabled for the cgroup.
+  stream = cgroup_fopen(cgroup, "memory.peak");
+  if (stream == NULL) {
+    return errno == ENOENT ? 0 : -errno;
+  }
+
+  if (fscanf(stream, "%" SCNd64, &value) == 1) {
+    usage->cgroup.memory_peak = value;
+  }
+
+  fclose(stream);
+
+  return 0;
+}
+
+cgroup_type cgroup_destroy(cgroup_type cgroup)
+{
+  if (cgroup == CGROUP_INVALID) {
+    return CGROUP_INVALID;
+  }
+
+  int r = close(cgroup);
+  ASSERT_UNUSED(r == 0);
+
+  return CGROUP_INVALID;
+}
@@ -0,0 +1,41 @@
+#include "cgroup.h"
+
+#include <windows.h>
+
+#include "macro.h"
+
+const cgroup_type CGROUP_INVALID = -1;
+
+int cgroup_open(reproc_cgroup options, cgroup_type *cgroup)
+{
+  ASSERT(cgroup);
+
+  *cgroup = CGROUP_INVALID;
+
+  return options.path == NULL ? 0 : -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int cgroup_enter(cgroup_type cgroup)
+{
+  (void) cgroup;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int cgroup_kill(cgroup_type cgroup)
+{
+  (void) cgroup;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int cgroup_stats(cgroup_type cgroup, reproc_usage *usage)
+{
+  (void) cgroup;
+  (void) usage;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+cgroup_type cgroup_destroy(cgroup_type cgroup)
+{
+  (void) cgroup;
+  return CGROUP_INVALID;
+}
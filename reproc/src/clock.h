@@ -2,4 +2,8 @@
 
 #include <stdint.h>
 
+// Milliseconds of the clock used for deadlines.
 int64_t now(void);
+
+// Nanoseconds of a monotonic clock.
+int64_t monotonic(void);
@@ -15,3 +15,13 @@ int64_t now(void)
 
   return timespec.tv_sec * 1000 + timespec.tv_nsec / 1000000;
 }
+
+int64_t monotonic(void)
+{
+  struct timespec timespec = { 0 };
+
+  int r = clock_gettime(CLOCK_MONOTONIC, &timespec);
+  ASSERT_UNUSED(r == 0);
+
+  return timespec.tv_sec * 1000000000LL + timespec.tv_nsec;
+}
@@ -12,3 +12,17 @@ int64_t now(void)
 {
   return (int64_t) GetTickCount64();
 }
+
+int64_t monotonic(void)
+{
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+
+  int64_t seconds = counter.QuadPart / frequency.QuadPart;
+  int64_t rest = counter.QuadPart % frequency.QuadPart;
+
+  return seconds * 1000000000LL + rest * 1000000000LL / frequency.QuadPart;
+}
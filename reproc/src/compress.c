@@ -0,0 +1,409 @@
+#include <reproc/compress.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(REPROC_MULTITHREADED) && !defined(_WIN32)
+  #define COMPRESS_THREAD
+  #include <pthread.h>
+#endif
+
+#include "error.h"
+#include "lz4.h"
+
+enum { BLOCK_SIZE = 65536, QUEUE_DEFAULT = 4 };
+
+// The high bit of a block size indicates the block is stored uncompressed.
+static const uint32_t BLOCK_UNCOMPRESSED = 0x80000000U;
+
+// Magic number, FLG (version 1, independent blocks, no checksums), BD (blocks
+// of at most 64 KiB) and HC (second byte of the xxHash32 of FLG and BD).
+static const uint8_t FRAME_HEADER[] = { 0x04, 0x22, 0x4D, 0x18,
+                                        0x60, 0x40, 0x82 };
+
+// A block size of zero ends the frame.
+static const uint8_t FRAME_END[] = { 0, 0, 0, 0 };
+
+struct reproc_compressor {
+  reproc_compress_options options;
+  // `queue` blocks of `BLOCK_SIZE` bytes. The `count` blocks starting at `head`
+  // are waiting to be compressed. Output is copied into the block after those
+  // until it's full.
+  uint8_t *blocks;
+  size_t *sizes;
+  size_t head;
+  size_t count;
+  // Compressed block prefixed with its size.
+  uint8_t *output;
+  uint32_t *table;
+  bool header;
+  bool finished;
+  int error;
+#if defined(COMPRESS_THREAD)
+  bool running;
+  bool stop;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  // Signaled whenever `count` or `stop` changes.
+  pthread_cond_t changed;
+#endif
+};
+
+static void compressor_lock(reproc_compressor *compressor)
+{
+#if defined(COMPRESS_THREAD)
+  if (compressor->running) {
+    int r = pthread_mutex_lock(&compressor->mutex);
+    ASSERT_UNUSED(r == 0);
+  }
+#else
+  (void) compressor;
+#endif
+}
+
+static void compressor_unlock(reproc_compressor *compressor)
+{
+#if defined(COMPRESS_THREAD)
+  if (compressor->running) {
+    int r = pthread_mutex_unlock(&compressor->mutex);
+    ASSERT_UNUSED(r == 0);
+  }
+#else
+  (void) compressor;
+#endif
+}
+
+static int output_write(reproc_compressor *compressor,
+                        const uint8_t *buffer,
+                        size_t size)
+{
+  reproc_compress_options *options = &compressor->options;
+
+  if (options->file != NULL) {
+    size_t written = fwrite(buffer, 1, size, options->file);
+    return written == size ? 0 : REPROC_EPIPE;
+  }
+
+  return options->output.function(buffer, size, options->output.context);
+}
+
+static void store32(uint8_t *buffer, uint32_t value)
+{
+  for (size_t i = 0; i < 4; i++) {
+    buffer[i] = (uint8_t) (value >> (8 * i));
+  }
+}
+
+// Compresses `block` and writes it to the output. Only called by one thread at
+// a time.
+static int block_write(reproc_compressor *compressor,
+                       const uint8_t *block,
+                       size_t size)
+{
+  int r = 0;
+
+  if (!compressor->header) {
+    r = output_write(compressor, FRAME_HEADER, sizeof(FRAME_HEADER));
+    if (r != 0) {
+      return r;
+    }
+
+    compressor->header = true;
+  }
+
+  if (size == 0) {
+    return 0;
+  }
+
+  uint8_t *output = compressor->output;
+  size_t compressed = lz4_compress(block, size, output + 4, compressor->table);
+
+  // Blocks that don't compress are stored as is.
+  if (compressed >= size) {
+    memcpy(output + 4, block, size);
+    store32(output, (uint32_t) size | BLOCK_UNCOMPRESSED);
+    compressed = size;
+  } else {
+    store32(output, (uint32_t) compressed);
+  }
+
+  return output_write(compressor, output, compressed + 4);
+}
+
+static uint8_t *block_at(reproc_compressor *compressor, size_t index)
+{
+  return compressor->blocks + (index % compressor->options.queue) * BLOCK_SIZE;
+}
+
+static size_t *size_at(reproc_compressor *compressor, size_t index)
+{
+  return &compressor->sizes[index % compressor->options.queue];
+}
+
+#if defined(COMPRESS_THREAD)
+static void *compressor_main(void *context)
+{
+  reproc_compressor *compressor = context;
+
+  compressor_lock(compressor);
+
+  for (;;) {
+    while (compressor->count == 0 && !compressor->stop) {
+      pthread_cond_wait(&compressor->changed, &compressor->mutex);
+    }
+
+    if (compressor->count == 0) {
+      break;
+    }
+
+    // The block at `head` isn't touched by the sink until we release it so we
+    // can compress it without holding the lock.
+    uint8_t *block = block_at(compressor, compressor->head);
+    size_t size = *size_at(compressor, compressor->head);
+    bool failed = compressor->error != 0;
+
+    compressor_unlock(compressor);
+    int r = failed ? 0 : block_write(compressor, block, size);
+    compressor_lock(compressor);
+
+    if (r != 0 && compressor->error == 0) {
+      compressor->error = r;
+    }
+
+    *size_at(compressor, compressor->head) = 0;
+    compressor->head++;
+    compressor->count--;
+    pthread_cond_broadcast(&compressor->changed);
+  }
+
+  compressor_unlock(compressor);
+
+  return NULL;
+}
+#endif
+
+// Hands the block that's being filled to the compression thread or compresses
+// it directly if there's no thread. Called with the lock held.
+static int block_submit(reproc_compressor *compressor)
+{
+  size_t tail = compressor->head + compressor->count;
+
+#if defined(COMPRESS_THREAD)
+  if (compressor->running) {
+    compressor->count++;
+    pthread_cond_broadcast(&compressor->changed);
+
+    // Wait until there's room for the next block.
+    while (compressor->count == compressor->options.queue) {
+      pthread_cond_wait(&compressor->changed, &compressor->mutex);
+    }
+
+    return compressor->error;
+  }
+#endif
+
+  int r = block_write(compressor, block_at(compressor, tail),
+                      *size_at(compressor, tail));
+  *size_at(compressor, tail) = 0;
+
+  return r;
+}
+
+reproc_compressor *reproc_compressor_new(reproc_compress_options options)
+{
+  if ((options.output.function == NULL) == (options.file == NULL)) {
+    return NULL;
+  }
+
+#if !defined(COMPRESS_THREAD)
+  if (options.thread) {
+    return NULL;
+  }
+#endif
+
+  options.queue = options.queue == 0 ? QUEUE_DEFAULT : options.queue;
+  // Without a thread, blocks are compressed as soon as they're full.
+  options.queue = options.thread ? options.queue + 1 : 1;
+
+  reproc_compressor *compressor = calloc(1, sizeof(reproc_compressor));
+  if (compressor == NULL) {
+    return NULL;
+  }
+
+  compressor->options = options;
+  compressor->blocks = malloc(options.queue * BLOCK_SIZE);
+  compressor->sizes = calloc(options.queue, sizeof(size_t));
+  compressor->output = malloc(4 + LZ4_BOUND(BLOCK_SIZE));
+  compressor->table = malloc(LZ4_TABLE_SIZE * sizeof(uint32_t));
+
+  if (compressor->blocks == NULL || compressor->sizes == NULL ||
+      compressor->output == NULL || compressor->table == NULL) {
+    return reproc_compressor_destroy(compressor);
+  }
+
+#if defined(COMPRESS_THREAD)
+  if (options.thread) {
+    if (pthread_mutex_init(&compressor->mutex, NULL) != 0) {
+      return reproc_compressor_destroy(compressor);
+    }
+
+    if (pthread_cond_init(&compressor->changed, NULL) != 0) {
+      pthread_mutex_destroy(&compressor->mutex);
+      return reproc_compressor_destroy(compressor);
+    }
+
+    // Set before starting the thread so it locks the mutex from the start.
+    compressor->running = true;
+
+    if (pthread_create(&compressor->thread, NULL, compressor_main,
+                       compressor) != 0) {
+      compressor->running = false;
+      pthread_cond_destroy(&compressor->changed);
+      pthread_mutex_destroy(&compressor->mutex);
+      return reproc_compressor_destroy(compressor);
+    }
+  }
+#endif
+
+  return compressor;
+}
+
+static int sink_compress(REPROC_STREAM stream,
+                         const uint8_t *buffer,
+                         size_t size,
+                         void *context)
+{
+  (void) stream;
+
+  reproc_compressor *compressor = context;
+  int r = 0;
+
+  compressor_lock(compressor);
+
+  if (compressor->finished) {
+    r = REPROC_EINVAL;
+    goto finish;
+  }
+
+  while (size > 0 && compressor->error == 0) {
+    size_t tail = compressor->head + compressor->count;
+    size_t *fill = size_at(compressor, tail);
+    size_t copy = BLOCK_SIZE - *fill < size ? BLOCK_SIZE - *fill : size;
+
+    // Only the compression thread accesses blocks before `tail`.
+    memcpy(block_at(compressor, tail) + *fill, buffer, copy);
+    *fill += copy;
+    buffer += copy;
+    size -= copy;
+
+    if (*fill == BLOCK_SIZE) {
+      r = block_submit(compressor);
+      if (r != 0 && compressor->error == 0) {
+        compressor->error = r;
+      }
+    }
+  }
+
+  r = compressor->error;
+
+finish:
+  compressor_unlock(compressor);
+
+  return r;
+}
+
+reproc_sink reproc_sink_compress(reproc_compressor *compressor)
+{
+  return (reproc_sink){ sink_compress, compressor };
+}
+
+// Compresses the remaining queued blocks and stops the compression thread.
+static void compressor_stop(reproc_compressor *compressor)
+{
+#if defined(COMPRESS_THREAD)
+  if (!compressor->running) {
+    return;
+  }
+
+  compressor_lock(compressor);
+  compressor->stop = true;
+  pthread_cond_broadcast(&compressor->changed);
+  compressor_unlock(compressor);
+
+  int r = pthread_join(compressor->thread, NULL);
+  ASSERT_UNUSED(r == 0);
+
+  pthread_cond_destroy(&compressor->changed);
+  pthread_mutex_destroy(&compressor->mutex);
+  compressor->running = false;
+#else
+  (void) compressor;
+#endif
+}
+
+int reproc_compressor_finish(reproc_compressor *compressor)
+{
+  ASSERT_EINVAL(compressor);
+
+  compressor_lock(compressor);
+
+  if (compressor->finished) {
+    compressor_unlock(compressor);
+    return REPROC_EINVAL;
+  }
+
+  compressor->finished = true;
+
+  // Submit the partially filled block, if any.
+  size_t tail = compressor->head + compressor->count;
+  if (*size_at(compressor, tail) > 0 && compressor->error == 0) {
+#if defined(COMPRESS_THREAD)
+    if (compressor->running) {
+      compressor->count++;
+      pthread_cond_broadcast(&compressor->changed);
+    } else
+#endif
+    {
+      compressor->error = block_submit(compressor);
+    }
+  }
+
+  compressor_unlock(compressor);
+  compressor_stop(compressor);
+
+  int r = compressor->error;
+
+  if (r == 0) {
+    // Writes the header if no output was compressed at all.
+    r = block_write(compressor, NULL, 0);
+  }
+
+  if (r == 0) {
+    r = output_write(compressor, FRAME_END, sizeof(FRAME_END));
+  }
+
+  if (r == 0 && compressor->options.file != NULL) {
+    r = fflush(compressor->options.file) == 0 ? 0 : REPROC_EPIPE;
+  }
+
+  compressor->error = r;
+
+  return r;
+}
+
+reproc_compressor *reproc_compressor_destroy(reproc_compressor *compressor)
+{
+  if (compressor == NULL) {
+    return NULL;
+  }
+
+  compressor_stop(compressor);
+
+  free(compressor->blocks);
+  free(compressor->sizes);
+  free(compressor->output);
+  free(compressor->table);
+  free(compressor);
+
+  return NULL;
+}
@@ -3,16 +3,39 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "clock.h"
 #include "error.h"
 #include "macro.h"
+#include "pipe.h"
 
-int reproc_drain(reproc_t *process, reproc_sink out, reproc_sink err)
+// Output is read in chunks of this size.
+enum { BUFFER_SIZE = 65536 };
+
+// Writes to stdin are limited to the amount of bytes that can always be written
+// to a pipe that's writable without blocking.
+enum { WRITE_SIZE = 4096 };
+
+int reproc_communicate(reproc_t *process,
+                       reproc_source in,
+                       reproc_sink out,
+                       reproc_sink err)
 {
   ASSERT_EINVAL(process);
   ASSERT_EINVAL(out.function);
   ASSERT_EINVAL(err.function);
 
   const uint8_t initial = 0;
+  uint8_t *buffer = NULL;
+  bool writing = in.function != NULL;
+  size_t turn = 0;
+
+  // Input produced by `in` that hasn't been written to stdin yet.
+  struct {
+    uint8_t *data;
+    size_t offset;
+    size_t size;
+  } input = { 0 };
+
   int r = -1;
 
   // A single call to `read` might contain multiple messages. By always calling
@@ -30,11 +53,24 @@ int reproc_drain(reproc_t *process, reproc_sink out, reproc_sink err)
     return r;
   }
 
-  uint8_t buffer[4096];
+  buffer = malloc(BUFFER_SIZE);
+  if (buffer == NULL) {
+    r = REPROC_ENOMEM;
+    goto finish;
+  }
+
+  if (writing) {
+    input.data = malloc(BUFFER_SIZE);
+    if (input.data == NULL) {
+      r = REPROC_ENOMEM;
+      goto finish;
+    }
+  }
 
   for (;;) {
-    reproc_event_source source = { process, REPROC_EVENT_OUT | REPROC_EVENT_ERR,
-                                   0 };
+    int interests = REPROC_EVENT_OUT | REPROC_EVENT_ERR;
+    interests |= writing ? REPROC_EVENT_IN : 0;
+    reproc_event_source source = { process, interests, 0 };
 
     r = reproc_poll(&source, 1, REPROC_INFINITE);
     if (r < 0) {
@@ -47,26 +83,91 @@ int reproc_drain(reproc_t *process, reproc_sink out, reproc_sink err)
       break;
     }
 
-    REPROC_STREAM stream = source.events & REPROC_EVENT_OUT ? REPROC_STREAM_OUT
-                                                            : REPROC_STREAM_ERR;
+    if (source.events & REPROC_EVENT_IN) {
+      if (input.offset == input.size) {
+        size_t produced = 0;
 
-    r = reproc_read(process, stream, buffer, ARRAY_SIZE(buffer));
-    if (r < 0 && r != REPROC_EPIPE) {
-      break;
+        r = in.function(input.data, BUFFER_SIZE, &produced, in.context);
+        if (r != 0) {
+          break;
+        }
+
+        if (produced == 0) {
+          r = reproc_close(process, REPROC_STREAM_IN);
+          if (r < 0) {
+            break;
+          }
+
+          writing = false;
+        }
+
+        input.offset = 0;
+        input.size = MIN(produced, BUFFER_SIZE);
+      }
+
+      if (input.offset < input.size) {
+        size_t size = MIN(input.size - input.offset, WRITE_SIZE);
+
+        // Block `SIGPIPE` so writing to a child process that exited fails
+        // with `REPROC_EPIPE` instead.
+        bool blocked = pipe_sigpipe_block();
+        r = reproc_write(process, input.data + input.offset, size);
+        pipe_sigpipe_unblock(blocked);
+
+        if (r == REPROC_EPIPE) {
+          // The child process closed its stdin so it isn't interested in the
+          // rest of the input.
+          writing = false;
+        } else if (r < 0 && r != REPROC_EWOULDBLOCK) {
+          break;
+        } else if (r > 0) {
+          input.offset += (size_t) r;
+        }
+      }
     }
 
-    size_t bytes_read = r == REPROC_EPIPE ? 0 : (size_t) r;
-    reproc_sink sink = stream == REPROC_STREAM_OUT ? out : err;
+    // Read from every output stream that's ready instead of only from stdout so
+    // a child process that keeps stdout busy can't starve stderr. The stream
+    // that's read from first alternates between iterations.
+    for (size_t i = 0; i < 2; i++) {
+      REPROC_STREAM stream = (i + turn) % 2 == 0 ? REPROC_STREAM_OUT
+                                                 : REPROC_STREAM_ERR;
+      int event = stream == REPROC_STREAM_OUT ? REPROC_EVENT_OUT
+                                              : REPROC_EVENT_ERR;
 
-    r = sink.function(stream, buffer, bytes_read, sink.context);
-    if (r != 0) {
-      break;
+      if (!(source.events & event)) {
+        continue;
+      }
+
+      r = reproc_read(process, stream, buffer, BUFFER_SIZE);
+      if (r < 0 && r != REPROC_EPIPE) {
+        goto finish;
+      }
+
+      size_t bytes_read = r == REPROC_EPIPE ? 0 : (size_t) r;
+      reproc_sink sink = stream == REPROC_STREAM_OUT ? out : err;
+
+      r = sink.function(stream, buffer, bytes_read, sink.context);
+      if (r != 0) {
+        goto finish;
+      }
     }
+
+    turn ^= 1;
   }
 
+finish:
+  free(buffer);
+  free(input.data);
+
   return r;
 }
 
+int reproc_drain(reproc_t *process, reproc_sink out, reproc_sink err)
+{
+  return reproc_communicate(process, REPROC_SOURCE_NULL, out, err);
+}
+
 static int sink_string(REPROC_STREAM stream,
                        const uint8_t *buffer,
                        size_t size,
@@ -114,6 +215,113 @@ reproc_sink reproc_sink_discard(void)
 
 const reproc_sink REPROC_SINK_NULL = { sink_discard, NULL };
 
+static int sink_timed(REPROC_STREAM stream,
+                      const uint8_t *buffer,
+                      size_t size,
+                      void *context)
+{
+  const reproc_timed_sink *sink = (const reproc_timed_sink *) context;
+  return sink->function(stream, buffer, size, monotonic(), sink->context);
+}
+
+reproc_sink reproc_sink_timed(const reproc_timed_sink *sink)
+{
+  return (reproc_sink){ sink_timed, (void *) sink };
+}
+
+static int sink_tee(REPROC_STREAM stream,
+                    const uint8_t *buffer,
+                    size_t size,
+                    void *context)
+{
+  const reproc_tee *tee = (const reproc_tee *) context;
+
+  for (size_t i = 0; i < tee->size; i++) {
+    reproc_sink sink = tee->sinks[i];
+
+    int r = sink.function(stream, buffer, size, sink.context);
+    if (r != 0) {
+      return r;
+    }
+  }
+
+  return 0;
+}
+
+reproc_sink reproc_sink_tee(reproc_tee *tee)
+{
+  return (reproc_sink){ sink_tee, tee };
+}
+
+static int sink_filter(REPROC_STREAM stream,
+                       const uint8_t *buffer,
+                       size_t size,
+                       void *context)
+{
+  const reproc_filter *filter = (const reproc_filter *) context;
+
+  if (!filter->predicate(stream, buffer, size, filter->context)) {
+    return 0;
+  }
+
+  return filter->sink.function(stream, buffer, size, filter->sink.context);
+}
+
+reproc_sink reproc_sink_filter(reproc_filter *filter)
+{
+  return (reproc_sink){ sink_filter, filter };
+}
+
+static int sink_limit(REPROC_STREAM stream,
+                      const uint8_t *buffer,
+                      size_t size,
+                      void *context)
+{
+  reproc_limiter *limiter = (reproc_limiter *) context;
+  size_t remaining = limiter->size - limiter->forwarded;
+
+  if (size > 0 && remaining == 0) {
+    return 0;
+  }
+
+  size = MIN(size, remaining);
+  limiter->forwarded += size;
+
+  return limiter->sink.function(stream, buffer, size, limiter->sink.context);
+}
+
+reproc_sink reproc_sink_limit(reproc_limiter *limiter)
+{
+  return (reproc_sink){ sink_limit, limiter };
+}
+
+static int sink_sample(REPROC_STREAM stream,
+                       const uint8_t *buffer,
+                       size_t size,
+                       void *context)
+{
+  reproc_sampler *sampler = (reproc_sampler *) context;
+  ASSERT_EINVAL(sampler->every > 0);
+
+  if (size > 0 && sampler->count++ % sampler->every != 0) {
+    return 0;
+  }
+
+  return sampler->sink.function(stream, buffer, size, sampler->sink.context);
+}
+
+reproc_sink reproc_sink_sample(reproc_sampler *sampler)
+{
+  return (reproc_sink){ sink_sample, sampler };
+}
+
+int64_t reproc_now(void)
+{
+  return monotonic();
+}
+
+const reproc_source REPROC_SOURCE_NULL = { NULL, NULL };
+
 void *reproc_free(void *ptr)
 {
   free(ptr);
@@ -0,0 +1,113 @@
+#include "lz4.h"
+
+#include <string.h>
+
+// Matches are at least 4 bytes long. The last 5 bytes of a block are always
+// literals and the last match starts at least 12 bytes before the end of the
+// block.
+enum { MIN_MATCH = 4, LAST_LITERALS = 5, MF_LIMIT = 12 };
+
+enum { MAX_OFFSET = 65535 };
+
+static uint32_t read32(const uint8_t *p)
+{
+  uint32_t value = 0;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t hash(uint32_t value)
+{
+  // Knuth's multiplicative hash. `LZ4_TABLE_SIZE` is 2^12.
+  return (value * 2654435761U) >> (32 - 12);
+}
+
+static uint8_t *length_write(uint8_t *dst, size_t length)
+{
+  for (; length >= 255; length -= 255) {
+    *dst++ = 255;
+  }
+
+  *dst++ = (uint8_t) length;
+
+  return dst;
+}
+
+// Writes a sequence of `literals` bytes of literals followed by a match of
+// `match` bytes at `offset` bytes back. If `match` is zero, only the literals
+// are written which is how a block ends.
+static uint8_t *sequence_write(uint8_t *dst,
+                               const uint8_t *literal,
+                               size_t literals,
+                               size_t offset,
+                               size_t match)
+{
+  uint8_t *token = dst++;
+  size_t extra = match > 0 ? match - MIN_MATCH : 0;
+
+  *token = (uint8_t) ((literals < 15 ? literals : 15) << 4);
+
+  if (literals >= 15) {
+    dst = length_write(dst, literals - 15);
+  }
+
+  memcpy(dst, literal, literals);
+  dst += literals;
+
+  if (match == 0) {
+    return dst;
+  }
+
+  *token |= (uint8_t) (extra < 15 ? extra : 15);
+
+  *dst++ = (uint8_t) (offset & 0xFF);
+  *dst++ = (uint8_t) (offset >> 8);
+
+  if (extra >= 15) {
+    dst = length_write(dst, extra - 15);
+  }
+
+  return dst;
+}
+
+size_t lz4_compress(const uint8_t *src, size_t size, uint8_t *dst,
+                    uint32_t *table)
+{
+  uint8_t *out = dst;
+  size_t anchor = 0;
+  size_t i = 0;
+
+  // Positions are stored plus one so zero means the entry is empty.
+  memset(table, 0, LZ4_TABLE_SIZE * sizeof(*table));
+
+  while (i + MF_LIMIT <= size) {
+    uint32_t value = read32(src + i);
+    uint32_t h = hash(value);
+    size_t candidate = table[h];
+
+    table[h] = (uint32_t) i + 1;
+
+    if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET ||
+        read32(src + candidate - 1) != value) {
+      i++;
+      continue;
+    }
+
+    size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+
+    while (i + length < size - LAST_LITERALS &&
+           src[match + length] == src[i + length]) {
+      length++;
+    }
+
+    out = sequence_write(out, src + anchor, i - anchor, i - match, length);
+
+    i += length;
+    anchor = i;
+  }
+
+  out = sequence_write(out, src + anchor, size - anchor, 0, 0);
+
+  return (size_t) (out - dst);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Amount of entries of the hash table passed to `lz4_compress`.
+enum { LZ4_TABLE_SIZE = 1 << 12 };
+
+// Size of a buffer that is always large enough to hold the compressed form of
+// `size` bytes.
+#define LZ4_BOUND(size) ((size) + (size) / 255 + 16)
+
+// Compresses `size` bytes from `src` into `dst` as a single independent block
+// in the LZ4 block format and returns the compressed size. `dst` must hold at
+// least `LZ4_BOUND(size)` bytes. `table` is scratch space of `LZ4_TABLE_SIZE`
+// entries.
+size_t lz4_compress(const uint8_t *src, size_t size, uint8_t *dst,
+                    uint32_t *table);
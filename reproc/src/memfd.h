@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "handle.h"
+
+// Creates an anonymous file that only exists as long as it's open. On Linux,
+// this is a memfd that can be sealed. Elsewhere, it's an unlinked temporary
+// file.
+//
+// POSIX only.
+int memfd_open(handle_type *file);
+
+// Prevents `file` from being modified any further. Succeeds without doing
+// anything if `file` doesn't support seals. `file` may not be mapped writable.
+//
+// POSIX only.
+int memfd_seal(handle_type file);
+
+// Creates a sealed anonymous file that contains `data` and is positioned at its
+// start.
+//
+// POSIX only.
+int memfd_from(const uint8_t *data, size_t size, handle_type *file);
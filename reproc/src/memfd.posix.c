@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L
+// `memfd_create` and file seals aren't part of POSIX.
+#define _GNU_SOURCE
+
+#include "memfd.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+  #include <sys/syscall.h>
+#endif
+
+#include <reproc/reproc.h>
+
+#include "error.h"
+
+#ifndef MFD_CLOEXEC
+  #define MFD_CLOEXEC 0x0001U
+#endif
+
+#ifndef MFD_ALLOW_SEALING
+  #define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+int memfd_open(int *file)
+{
+  ASSERT(file);
+
+  int r = -1;
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+  r = (int) syscall(SYS_memfd_create, "reproc",
+                    MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (r >= 0) {
+    *file = r;
+    return 0;
+  }
+
+  if (errno != ENOSYS) {
+    return -errno;
+  }
+#endif
+
+  const char *directory = getenv("TMPDIR");
+  directory = directory == NULL ? "/tmp" : directory;
+
+  const char *name = "/reproc-XXXXXX";
+  char *path = malloc(strlen(directory) + strlen(name) + 1);
+  if (path == NULL) {
+    return REPROC_ENOMEM;
+  }
+
+  strcpy(path, directory);
+  strcat(path, name);
+
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  // The file only has to exist as long as we keep it open.
+  unlink(path);
+
+  r = handle_cloexec(fd, true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  *file = fd;
+  fd = HANDLE_INVALID;
+
+finish:
+  free(path);
+  handle_destroy(fd);
+
+  return r;
+}
+
+int memfd_seal(int file)
+{
+  ASSERT(file != HANDLE_INVALID);
+
+#if defined(F_ADD_SEALS)
+  // Only memfds can be sealed so this fails for temporary files.
+  int r = fcntl(file, F_ADD_SEALS,
+                F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+  if (r < 0 && errno != EINVAL) {
+    return -errno;
+  }
+#endif
+
+  return 0;
+}
+
+int memfd_from(const uint8_t *data, size_t size, int *file)
+{
+  ASSERT(data || size == 0);
+  ASSERT(file);
+
+  int fd = HANDLE_INVALID;
+  size_t written = 0;
+  int r = -1;
+
+  r = memfd_open(&fd);
+  if (r < 0) {
+    return r;
+  }
+
+  while (written < size) {
+    ssize_t n = write(fd, data + written, size - written);
+    if (n < 0) {
+      r = -errno;
+      goto finish;
+    }
+
+    written += (size_t) n;
+  }
+
+  if (lseek(fd, 0, SEEK_SET) < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = memfd_seal(fd);
+  if (r < 0) {
+    goto finish;
+  }
+
+  *file = fd;
+  fd = HANDLE_INVALID;
+
+finish:
+  handle_destroy(fd);
+
+  return r;
+}
@@ -0,0 +1,23 @@
+#include "memfd.h"
+
+#include <windows.h>
+
+int memfd_open(HANDLE *file)
+{
+  (void) file;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int memfd_seal(HANDLE file)
+{
+  (void) file;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int memfd_from(const uint8_t *data, size_t size, HANDLE *file)
+{
+  (void) data;
+  (void) size;
+  (void) file;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
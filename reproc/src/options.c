@@ -1,10 +1,13 @@
 #include "options.h"
 
 #include "error.h"
+#include "macro.h"
 
 static bool redirect_is_set(reproc_redirect redirect)
 {
-  return redirect.type || redirect.handle || redirect.file || redirect.path;
+  return redirect.type || redirect.handle || redirect.file || redirect.path ||
+         redirect.socket.seqpacket || redirect.socket.buffer ||
+         redirect.pty.rows || redirect.pty.columns || redirect.pty.controlling;
 }
 
 static int parse_redirect(reproc_redirect *redirect,
@@ -54,6 +57,27 @@ static int parse_redirect(reproc_redirect *redirect,
     redirect->type = REPROC_REDIRECT_PATH;
   }
 
+  if (redirect->type == REPROC_REDIRECT_SOCKET || redirect->socket.seqpacket ||
+      redirect->socket.buffer) {
+    ASSERT_EINVAL(redirect->type == REPROC_REDIRECT_DEFAULT ||
+                  redirect->type == REPROC_REDIRECT_SOCKET);
+    ASSERT_EINVAL(redirect->socket.buffer >= 0);
+    ASSERT_EINVAL(!redirect->handle && !redirect->file && !redirect->path);
+    redirect->type = REPROC_REDIRECT_SOCKET;
+  }
+
+  if (redirect->type == REPROC_REDIRECT_PTY || redirect->pty.rows ||
+      redirect->pty.columns || redirect->pty.controlling) {
+    ASSERT_EINVAL(redirect->type == REPROC_REDIRECT_DEFAULT ||
+                  redirect->type == REPROC_REDIRECT_PTY);
+    ASSERT_EINVAL(stream != REPROC_STREAM_IN);
+    ASSERT_EINVAL(redirect->pty.rows >= 0 && redirect->pty.rows <= UINT16_MAX);
+    ASSERT_EINVAL(redirect->pty.columns >= 0 &&
+                  redirect->pty.columns <= UINT16_MAX);
+    ASSERT_EINVAL(!redirect->handle && !redirect->file && !redirect->path);
+    redirect->type = REPROC_REDIRECT_PTY;
+  }
+
   if (redirect->type == REPROC_REDIRECT_DEFAULT) {
     if (parent) {
       ASSERT_EINVAL(!discard);
@@ -70,6 +94,65 @@ static int parse_redirect(reproc_redirect *redirect,
   return 0;
 }
 
+static int parse_limit(reproc_limit limit)
+{
+  if (limit.set) {
+    ASSERT_EINVAL(limit.soft <= limit.hard);
+  }
+
+  return 0;
+}
+
+static int parse_scheduling(reproc_scheduling scheduling)
+{
+  // The policies are used to index lookup tables when applying them. The casts
+  // avoid comparing an unsigned enum with zero.
+  ASSERT_EINVAL((int) scheduling.cpu.policy >= REPROC_SCHED_INHERIT &&
+                scheduling.cpu.policy <= REPROC_SCHED_RR);
+  ASSERT_EINVAL((int) scheduling.memory.policy >= REPROC_MEMPOLICY_INHERIT &&
+                scheduling.memory.policy <= REPROC_MEMPOLICY_LOCAL);
+  ASSERT_EINVAL((int) scheduling.io.type >= REPROC_IOPRIO_INHERIT &&
+                scheduling.io.type <= REPROC_IOPRIO_IDLE);
+
+  if (scheduling.affinity.size > 0) {
+    ASSERT_EINVAL(scheduling.affinity.cpus != NULL);
+  }
+
+  for (size_t i = 0; i < scheduling.affinity.size; i++) {
+    ASSERT_EINVAL(scheduling.affinity.cpus[i] >= 0);
+  }
+
+  switch (scheduling.memory.policy) {
+    case REPROC_MEMPOLICY_BIND:
+    case REPROC_MEMPOLICY_INTERLEAVE:
+      ASSERT_EINVAL(scheduling.memory.size > 0);
+      break;
+    case REPROC_MEMPOLICY_PREFERRED:
+      ASSERT_EINVAL(scheduling.memory.size <= 1);
+      break;
+    default:
+      ASSERT_EINVAL(scheduling.memory.size == 0);
+  }
+
+  if (scheduling.memory.size > 0) {
+    ASSERT_EINVAL(scheduling.memory.nodes != NULL);
+  }
+
+  for (size_t i = 0; i < scheduling.memory.size; i++) {
+    ASSERT_EINVAL(scheduling.memory.nodes[i] >= 0);
+  }
+
+  if (scheduling.nice.set) {
+    ASSERT_EINVAL(scheduling.nice.value >= -20 && scheduling.nice.value <= 19);
+  }
+
+  if (scheduling.io.type != REPROC_IOPRIO_INHERIT) {
+    ASSERT_EINVAL(scheduling.io.level >= 0 && scheduling.io.level <= 7);
+  }
+
+  return 0;
+}
+
 reproc_stop_actions parse_stop_actions(reproc_stop_actions stop)
 {
   bool is_noop = stop.first.action == REPROC_STOP_NOOP &&
@@ -113,6 +196,32 @@ int parse_options(reproc_options *options, const char *const *argv)
     return r;
   }
 
+  if (options->redirect.in.type == REPROC_REDIRECT_SOCKET &&
+      options->redirect.out.type == REPROC_REDIRECT_SOCKET) {
+    ASSERT_EINVAL(options->redirect.in.socket.seqpacket ==
+                  options->redirect.out.socket.seqpacket);
+    ASSERT_EINVAL(options->redirect.in.socket.buffer ==
+                  options->redirect.out.socket.buffer);
+  }
+
+  if (options->redirect.out.type == REPROC_REDIRECT_PTY &&
+      options->redirect.err.type == REPROC_REDIRECT_PTY) {
+    ASSERT_EINVAL(options->redirect.out.pty.rows ==
+                  options->redirect.err.pty.rows);
+    ASSERT_EINVAL(options->redirect.out.pty.columns ==
+                  options->redirect.err.pty.columns);
+    ASSERT_EINVAL(options->redirect.out.pty.controlling ==
+                  options->redirect.err.pty.controlling);
+    // stderr is written to the pseudo-terminal of stdout.
+    options->redirect.err.type = REPROC_REDIRECT_STDOUT;
+  }
+
+  if (options->redirect.out.pty.controlling ||
+      options->redirect.err.pty.controlling) {
+    // Only a session leader can acquire a controlling terminal.
+    options->session = true;
+  }
+
   if (options->input.data != NULL) {
     ASSERT_EINVAL(options->redirect.in.type == REPROC_REDIRECT_PIPE);
   }
@@ -121,12 +230,59 @@ int parse_options(reproc_options *options, const char *const *argv)
     ASSERT_EINVAL(options->input.data != NULL);
   }
 
+  if (options->input.memfd) {
+    ASSERT_EINVAL(options->input.data != NULL);
+  }
+
+  if (options->input.file.handle || options->input.file.path != NULL) {
+    ASSERT_EINVAL(!options->input.file.handle ||
+                  options->input.file.path == NULL);
+    ASSERT_EINVAL(options->input.data == NULL);
+    ASSERT_EINVAL(options->redirect.in.type == REPROC_REDIRECT_PIPE);
+  }
+
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    reproc_extra_fd extra = options->extra_fds[i];
+
+    if (extra.fd == 0) {
+      ASSERT_EINVAL(!extra.input && !extra.handle);
+      continue;
+    }
+
+    ASSERT_EINVAL(extra.fd > 2);
+    ASSERT_EINVAL(!options->fork);
+
+    for (size_t j = 0; j < i; j++) {
+      ASSERT_EINVAL(options->extra_fds[j].fd != extra.fd);
+    }
+  }
+
+  if (options->ring.size > 0) {
+    ASSERT_EINVAL(!options->fork);
+  }
+
   if (options->fork) {
     ASSERT_EINVAL(argv == NULL);
   } else {
     ASSERT_EINVAL(argv != NULL && argv[0] != NULL);
   }
 
+  reproc_limit limits[] = { options->limits.as,    options->limits.cpu,
+                            options->limits.nofile, options->limits.nproc,
+                            options->limits.core,  options->limits.fsize };
+
+  for (size_t i = 0; i < ARRAY_SIZE(limits); i++) {
+    r = parse_limit(limits[i]);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  r = parse_scheduling(options->scheduling);
+  if (r < 0) {
+    return r;
+  }
+
   if (options->deadline == 0) {
     options->deadline = REPROC_INFINITE;
   }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <reproc/reproc.h>
+
+// Searches the directories in `path` (formatted like the PATH environment
+// variable) for an executable named `program` and stores the full path of the
+// executable in `resolved`. The caller is responsible for freeing `resolved`.
+//
+// `resolved` is set to `NULL` if `program` should be looked up by `execvp`
+// instead. This happens if `program` contains a slash, if `path` is `NULL` or
+// contains relative directories (which depend on the working directory of the
+// child process) or if no executable named `program` was found.
+//
+// If `cache` is true, the result of the lookup is stored in a process-wide
+// cache and later lookups of the same `program` and `path` reuse it as long as
+// none of the directories that were searched to find it have been modified.
+//
+// POSIX only.
+int path_resolve(const char *program,
+                 const char *path,
+                 bool cache,
+                 char **resolved);
+
+// Returns the amount of hits and misses of the cache used by `path_resolve`.
+reproc_cache_stats path_cache_stats(void);
@@ -0,0 +1,311 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "path.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(REPROC_MULTITHREADED)
+  #include <pthread.h>
+#endif
+
+#include "error.h"
+#include "macro.h"
+
+// `execvp` searches PATH by calling `execve` on every directory in PATH until
+// one of the calls succeeds. With long PATHs, this results in a lot of failed
+// system calls in the child process on every spawn. Instead, we search PATH
+// once in the parent process and remember the result. A cache entry remains
+// valid as long as the modification times of the directories that were
+// searched to find the executable don't change, which is the case as long as no
+// files are added, removed or renamed in those directories.
+
+enum { CACHE_SIZE = 32 };
+
+// Directories modified less than a second before they were searched are not
+// cached since a second modification in the same filesystem timestamp tick
+// would go unnoticed.
+static const int64_t RACY_NS = 1000000000;
+
+struct entry {
+  char *program;
+  char *path;
+  char *resolved;
+  // Modification times of the directories in `path` up to and including the
+  // directory that contains `resolved`.
+  int64_t *mtimes;
+  size_t num_mtimes;
+};
+
+static struct {
+  struct entry entries[CACHE_SIZE];
+  size_t next;
+  reproc_cache_stats stats;
+} cache;
+
+#if defined(REPROC_MULTITHREADED)
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void cache_lock(void)
+{
+#if defined(REPROC_MULTITHREADED)
+  int r = pthread_mutex_lock(&mutex);
+  ASSERT_UNUSED(r == 0);
+#endif
+}
+
+static void cache_unlock(void)
+{
+#if defined(REPROC_MULTITHREADED)
+  int r = pthread_mutex_unlock(&mutex);
+  ASSERT_UNUSED(r == 0);
+#endif
+}
+
+static int64_t stat_mtime(const struct stat *st)
+{
+#if defined(__APPLE__)
+  return (int64_t) st->st_mtime * 1000000000 + st->st_mtimensec;
+#else
+  return (int64_t) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+static int64_t now_ns(void)
+{
+  struct timespec timespec = { 0 };
+
+  int r = clock_gettime(CLOCK_REALTIME, &timespec);
+  ASSERT_UNUSED(r == 0);
+
+  return (int64_t) timespec.tv_sec * 1000000000 + timespec.tv_nsec;
+}
+
+// Returns true if every directory in `path` is an absolute path.
+static bool path_is_absolute(const char *path)
+{
+  for (const char *dir = path; dir != NULL;) {
+    if (*dir != '/') {
+      return false;
+    }
+
+    dir = strchr(dir, ':');
+    dir = dir == NULL ? NULL : dir + 1;
+  }
+
+  return true;
+}
+
+// Copies the directory of `path` starting at `dir` into `buffer` and returns
+// the start of the next directory or `NULL` if `dir` is the last directory.
+static const char *path_next(const char *dir, char *buffer)
+{
+  const char *end = strchr(dir, ':');
+  size_t size = end == NULL ? strlen(dir) : (size_t) (end - dir);
+
+  memcpy(buffer, dir, size);
+  buffer[size] = '\0';
+
+  return end == NULL ? NULL : end + 1;
+}
+
+static struct entry *cache_find(const char *program, const char *path)
+{
+  for (size_t i = 0; i < ARRAY_SIZE(cache.entries); i++) {
+    struct entry *entry = &cache.entries[i];
+
+    if (entry->program != NULL && strcmp(entry->program, program) == 0 &&
+        strcmp(entry->path, path) == 0) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void entry_free(struct entry *entry)
+{
+  free(entry->program);
+  free(entry->path);
+  free(entry->resolved);
+  free(entry->mtimes);
+  *entry = (struct entry){ 0 };
+}
+
+// Returns the modification time of the directory at `dir` or -1 if `dir` does
+// not exist or isn't a directory.
+static int64_t dir_mtime(const char *dir)
+{
+  struct stat st;
+
+  if (stat(dir, &st) < 0 || !S_ISDIR(st.st_mode)) {
+    return -1;
+  }
+
+  return stat_mtime(&st);
+}
+
+static bool entry_valid(const struct entry *entry, char *buffer)
+{
+  const char *dir = entry->path;
+
+  for (size_t i = 0; i < entry->num_mtimes; i++) {
+    ASSERT(dir != NULL);
+    dir = path_next(dir, buffer);
+
+    if (dir_mtime(buffer) != entry->mtimes[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Takes ownership of `mtimes`.
+static void cache_insert(const char *program,
+                         const char *path,
+                         const char *resolved,
+                         int64_t *mtimes,
+                         size_t num_mtimes)
+{
+  struct entry entry = { .program = strdup(program),
+                         .path = strdup(path),
+                         .resolved = strdup(resolved),
+                         .mtimes = mtimes,
+                         .num_mtimes = num_mtimes };
+
+  if (entry.program == NULL || entry.path == NULL || entry.resolved == NULL) {
+    // Caching is best effort.
+    entry_free(&entry);
+    return;
+  }
+
+  struct entry *slot = cache_find(program, path);
+
+  if (slot == NULL) {
+    slot = &cache.entries[cache.next];
+    cache.next = (cache.next + 1) % ARRAY_SIZE(cache.entries);
+  }
+
+  entry_free(slot);
+  *slot = entry;
+}
+
+int path_resolve(const char *program,
+                 const char *path,
+                 bool cache_enabled,
+                 char **resolved)
+{
+  ASSERT(program);
+  ASSERT(resolved);
+
+  size_t program_size = strlen(program);
+  char *buffer = NULL;
+  int64_t *mtimes = NULL;
+  size_t num_mtimes = 0;
+  bool racy = false;
+  int r = 0;
+
+  *resolved = NULL;
+
+  if (program_size == 0 || strchr(program, '/') != NULL || path == NULL ||
+      !path_is_absolute(path)) {
+    return 0;
+  }
+
+  // Large enough to hold any directory in `path` followed by `/program`.
+  buffer = malloc(strlen(path) + program_size + 2);
+  if (buffer == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  if (cache_enabled) {
+    cache_lock();
+
+    struct entry *entry = cache_find(program, path);
+
+    if (entry != NULL && entry_valid(entry, buffer)) {
+      cache.stats.hits++;
+      *resolved = strdup(entry->resolved);
+      r = *resolved == NULL ? -errno : 0;
+      cache_unlock();
+      goto finish;
+    }
+
+    cache.stats.misses++;
+    cache_unlock();
+  }
+
+  size_t num_dirs = 1;
+  for (const char *c = path; *c != '\0'; c++) {
+    num_dirs += *c == ':';
+  }
+
+  mtimes = calloc(num_dirs, sizeof(int64_t));
+  if (mtimes == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  int64_t n = now_ns();
+
+  for (const char *dir = path; dir != NULL;) {
+    dir = path_next(dir, buffer);
+
+    // Non-existing directories are remembered with an invalid modification
+    // time so we notice when they're created.
+    int64_t mtime = dir_mtime(buffer);
+    mtimes[num_mtimes++] = mtime;
+
+    if (mtime < 0) {
+      continue;
+    }
+
+    racy = racy || n - mtime < RACY_NS;
+
+    struct stat st;
+    size_t size = strlen(buffer);
+    buffer[size] = '/';
+    memcpy(buffer + size + 1, program, program_size + 1);
+
+    if (stat(buffer, &st) == 0 && S_ISREG(st.st_mode) &&
+        access(buffer, X_OK) == 0) {
+      *resolved = strdup(buffer);
+      if (*resolved == NULL) {
+        r = -errno;
+        goto finish;
+      }
+
+      break;
+    }
+  }
+
+  if (cache_enabled && *resolved != NULL && !racy) {
+    cache_lock();
+    cache_insert(program, path, *resolved, mtimes, num_mtimes);
+    cache_unlock();
+    mtimes = NULL;
+  }
+
+finish:
+  free(buffer);
+  free(mtimes);
+
+  return r;
+}
+
+reproc_cache_stats path_cache_stats(void)
+{
+  cache_lock();
+  reproc_cache_stats stats = cache.stats;
+  cache_unlock();
+
+  return stats;
+}
@@ -0,0 +1,9 @@
+#include "path.h"
+
+// `CreateProcessW` searches PATH itself so `path_resolve` is POSIX-only and the
+// cache is always empty on Windows.
+
+reproc_cache_stats path_cache_stats(void)
+{
+  return (reproc_cache_stats){ 0, 0 };
+}
@@ -38,9 +38,20 @@ int pipe_read(pipe_type pipe, uint8_t *buffer, size_t size);
 // returns the amount of bytes written.
 int pipe_write(pipe_type pipe, const uint8_t *buffer, size_t size);
 
+// Blocks `SIGPIPE` in the calling thread so writing to a pipe whose read end
+// was closed fails with `REPROC_EPIPE` instead of killing the process. Returns
+// true if `SIGPIPE` was blocked, in which case `pipe_sigpipe_unblock` has to be
+// called once the writes are done. Does nothing on Windows.
+bool pipe_sigpipe_block(void);
+
+// Discards the `SIGPIPE` signals raised since `pipe_sigpipe_block` and unblocks
+// `SIGPIPE` again if `blocked` is true.
+void pipe_sigpipe_unblock(bool blocked);
+
 // Polls the given event sources for events.
 int pipe_poll(pipe_event_source *sources, size_t num_sources, int timeout);
 
+// Shuts down the sending side of `pipe` if it is a socket.
 int pipe_shutdown(pipe_type pipe);
 
 pipe_type pipe_destroy(pipe_type pipe);
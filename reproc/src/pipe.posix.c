@@ -6,9 +6,15 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <poll.h>
+#include <signal.h>
 #include <stdlib.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#if defined(REPROC_MULTITHREADED)
+  #include <pthread.h>
+#endif
+
 #include "error.h"
 #include "handle.h"
 
@@ -82,6 +88,12 @@ int pipe_read(int pipe, uint8_t *buffer, size_t size)
     return -EPIPE;
   }
 
+  if (r < 0 && errno == EIO) {
+    // Reading from a pseudo-terminal fails with `EIO` instead of returning 0
+    // once the terminal is closed by the child process.
+    return -EPIPE;
+  }
+
   return r < 0 ? -errno : r;
 }
 
@@ -95,6 +107,65 @@ int pipe_write(int pipe, const uint8_t *buffer, size_t size)
   return r < 0 ? -errno : r;
 }
 
+static int sigpipe_mask(int how, const sigset_t *newmask, sigset_t *oldmask)
+{
+#if defined(REPROC_MULTITHREADED)
+  return -pthread_sigmask(how, newmask, oldmask);
+#else
+  return sigprocmask(how, newmask, oldmask) < 0 ? -errno : 0;
+#endif
+}
+
+bool pipe_sigpipe_block(void)
+{
+  sigset_t set;
+  sigset_t old;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGPIPE);
+
+  // If `SIGPIPE` is already blocked or pending, we can't tell our signals apart
+  // from others so we leave it alone. Blocked signals don't kill the process
+  // anyway and a pending one will be delivered regardless.
+  sigset_t pending;
+  sigemptyset(&pending);
+  if (sigpending(&pending) < 0 || sigismember(&pending, SIGPIPE)) {
+    return false;
+  }
+
+  if (sigpipe_mask(SIG_BLOCK, &set, &old) < 0) {
+    return false;
+  }
+
+  if (sigismember(&old, SIGPIPE)) {
+    return false;
+  }
+
+  return true;
+}
+
+void pipe_sigpipe_unblock(bool blocked)
+{
+  if (!blocked) {
+    return;
+  }
+
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGPIPE);
+
+  // `sigwait` doesn't block because we only call it if `SIGPIPE` is pending.
+  sigset_t pending;
+  sigemptyset(&pending);
+  if (sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE)) {
+    int signal = 0;
+    (void) sigwait(&set, &signal);
+  }
+
+  int r = sigpipe_mask(SIG_UNBLOCK, &set, NULL);
+  ASSERT_UNUSED(r == 0);
+}
+
 int pipe_poll(pipe_event_source *sources, size_t num_sources, int timeout)
 {
   ASSERT(num_sources <= INT_MAX);
@@ -131,7 +202,15 @@ finish:
 
 int pipe_shutdown(int pipe)
 {
-  (void) pipe;
+  if (pipe == PIPE_INVALID) {
+    return 0;
+  }
+
+  int r = shutdown(pipe, SHUT_WR);
+  if (r < 0 && errno != ENOTSOCK) {
+    return -errno;
+  }
+
   return 0;
 }
 
@@ -242,6 +242,16 @@ finish:
   return r;
 }
 
+bool pipe_sigpipe_block(void)
+{
+  return false;
+}
+
+void pipe_sigpipe_unblock(bool blocked)
+{
+  (void) blocked;
+}
+
 int pipe_shutdown(SOCKET pipe)
 {
   if (pipe == PIPE_INVALID) {
@@ -0,0 +1,181 @@
+#include <reproc/pipeline.h>
+
+#include "clock.h"
+#include "error.h"
+#include "pipe.h"
+
+static bool redirect_set(reproc_redirect redirect)
+{
+  return redirect.type != 0 || redirect.handle || redirect.file ||
+         redirect.path != NULL;
+}
+
+// Applies the `file` or `path` shorthand to `redirect` unless it's redirected
+// already.
+static void redirect_shorthand(reproc_redirect *redirect,
+                               FILE *file,
+                               const char *path)
+{
+  if (redirect_set(*redirect)) {
+    return;
+  }
+
+  if (file != NULL) {
+    redirect->type = REPROC_REDIRECT_FILE;
+    redirect->file = file;
+  } else if (path != NULL) {
+    redirect->type = REPROC_REDIRECT_PATH;
+    redirect->path = path;
+  }
+}
+
+int reproc_pipeline_start(reproc_t **processes,
+                          const char *const *const *argv,
+                          const reproc_options *options,
+                          size_t size)
+{
+  ASSERT_EINVAL(processes);
+  ASSERT_EINVAL(argv);
+  ASSERT_EINVAL(size > 0);
+
+  for (size_t i = 0; i < size; i++) {
+    ASSERT_EINVAL(processes[i]);
+
+    if (options == NULL) {
+      continue;
+    }
+
+    reproc_options stage = options[i];
+
+    if (i > 0) {
+      ASSERT_EINVAL(!redirect_set(stage.redirect.in));
+      ASSERT_EINVAL(stage.input.data == NULL);
+      ASSERT_EINVAL(!stage.input.file.handle);
+      ASSERT_EINVAL(stage.input.file.path == NULL);
+    }
+
+    if (i < size - 1) {
+      ASSERT_EINVAL(!redirect_set(stage.redirect.out));
+    }
+
+    ASSERT_EINVAL(!stage.redirect.parent || !stage.redirect.discard);
+    ASSERT_EINVAL(stage.redirect.file == NULL || stage.redirect.path == NULL);
+  }
+
+  // Read end of the pipe that's connected to the stdout of the previous
+  // process.
+  pipe_type previous = PIPE_INVALID;
+  int r = 0;
+
+  for (size_t i = 0; i < size; i++) {
+    reproc_options stage = options == NULL ? (reproc_options){ 0 }
+                                           : options[i];
+    pipe_type read = PIPE_INVALID;
+    pipe_type write = PIPE_INVALID;
+
+    if (i > 0) {
+      stage.redirect.in.type = REPROC_REDIRECT_HANDLE;
+      stage.redirect.in.handle = (reproc_handle) previous;
+    }
+
+    if (i < size - 1) {
+      r = pipe_init(&read, &write);
+      if (r < 0) {
+        break;
+      }
+
+      stage.redirect.out.type = REPROC_REDIRECT_HANDLE;
+      stage.redirect.out.handle = (reproc_handle) write;
+    }
+
+    // `parent` and `discard` only apply to streams that aren't redirected so
+    // they leave the pipes between the processes alone. `file` and `path`
+    // can't be combined with other redirects so we apply them to the other
+    // streams ourselves.
+    if (size > 1) {
+      redirect_shorthand(&stage.redirect.err, stage.redirect.file,
+                         stage.redirect.path);
+
+      if (i == size - 1) {
+        redirect_shorthand(&stage.redirect.out, stage.redirect.file,
+                           stage.redirect.path);
+      }
+
+      stage.redirect.file = NULL;
+      stage.redirect.path = NULL;
+    }
+
+    // Nothing reads the stderr of the processes in the pipeline so unless it's
+    // redirected, it goes to the parent's stderr instead of a pipe.
+    if (!redirect_set(stage.redirect.err) && !stage.redirect.discard) {
+      stage.redirect.err.type = REPROC_REDIRECT_PARENT;
+    }
+
+    r = reproc_start(processes[i], argv[i], stage);
+
+    // The child processes have their own copies of the pipe endpoints now. If
+    // we kept ours open, readers would never see the end of their input.
+    pipe_destroy(previous);
+    pipe_destroy(write);
+    previous = read;
+
+    if (r < 0) {
+      break;
+    }
+  }
+
+  pipe_destroy(previous);
+
+  return r < 0 ? r : 0;
+}
+
+int reproc_pipeline_wait(reproc_t **processes, size_t size, int timeout)
+{
+  ASSERT_EINVAL(processes);
+  ASSERT_EINVAL(size > 0);
+
+  int64_t deadline = timeout >= 0 ? now() + timeout : 0;
+  int status = 0;
+  int r = -1;
+
+  for (size_t i = 0; i < size; i++) {
+    int remaining = timeout;
+
+    if (timeout >= 0) {
+      int64_t n = now();
+      remaining = n >= deadline ? 0 : (int) (deadline - n);
+    }
+
+    r = reproc_wait(processes[i], remaining);
+    if (r < 0) {
+      return r;
+    }
+
+    // Like `pipefail`, the last non-zero exit status wins.
+    status = r != 0 ? r : status;
+  }
+
+  return status;
+}
+
+int reproc_pipeline_stop(reproc_t **processes,
+                         size_t size,
+                         reproc_stop_actions stop)
+{
+  ASSERT_EINVAL(processes);
+  ASSERT_EINVAL(size > 0);
+
+  int status = 0;
+  int r = -1;
+
+  for (size_t i = 0; i < size; i++) {
+    r = reproc_stop(processes[i], stop);
+    if (r < 0) {
+      return r;
+    }
+
+    status = r != 0 ? r : status;
+  }
+
+  return status;
+}
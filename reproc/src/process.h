@@ -1,6 +1,8 @@
 #pragma once
 
+#include "cgroup.h"
 #include "handle.h"
+#include "pipe.h"
 
 #include <stdbool.h>
 
@@ -14,6 +16,9 @@ typedef int process_type; // `pid_t`
 
 extern const process_type PROCESS_INVALID;
 
+// Room for `reproc_options.extra_fds` followed by the two handles of the ring.
+enum { PROCESS_EXTRA_MAX = REPROC_EXTRA_FDS_MAX + 2 };
+
 struct process_options {
   // If `NULL`, the child process inherits the environment of the current
   // process.
@@ -24,6 +29,26 @@ struct process_options {
   // If not `NULL`, the working directory of the child process is set to
   // `working_directory`.
   const char *working_directory;
+  // If true, the PATH lookup of `argv[0]` is cached across calls to
+  // `process_start`. POSIX only.
+  bool path_cache;
+  // Resource limits applied in the child process before calling `exec`. POSIX
+  // only.
+  reproc_limits limits;
+  // Scheduling parameters applied in the child process before calling `exec`.
+  // POSIX only.
+  reproc_scheduling scheduling;
+  // If not `CGROUP_INVALID`, the child process moves itself into this cgroup
+  // before doing anything else. Linux only.
+  cgroup_type cgroup;
+  // If true, the child process starts a new session (`setsid`) or process group
+  // (`setpgid`) whose ID is the child process ID. POSIX only.
+  bool session;
+  bool process_group;
+  // If not zero, the child process makes the terminal its standard stream
+  // `terminal` is redirected to its controlling terminal. Requires `session`.
+  // POSIX only.
+  int terminal;
   // The standard streams of the child process are redirected to the `in`, `out`
   // and `err` handles. If a handle is `HANDLE_INVALID`, the corresponding child
   // process standard stream is closed. The `exit` handle is simply inherited by
@@ -34,6 +59,12 @@ struct process_options {
     handle_type err;
     handle_type exit;
   } handle;
+  // Extra handles that are inherited by the child process as the file
+  // descriptors in `fd`. Entries where `fd` is zero are unused. POSIX only.
+  struct {
+    handle_type handle;
+    int fd;
+  } extra[PROCESS_EXTRA_MAX];
 };
 
 // Spawns a child process that executes the command stored in `argv`.
@@ -52,15 +83,27 @@ int process_start(process_type *process,
 // ID is returned from GetProcessId on the pointer.
 int process_pid(process_type process);
 
-// Returns the process's exit status if it has finished running.
-int process_wait(process_type process);
+// Returns the process's exit status if it has finished running and stores the
+// resources used by the process in `usage`.
+int process_wait(process_type process, reproc_usage *usage);
+
+// Like `process_wait` but returns `-EAGAIN` instead of waiting if `process`
+// hasn't exited yet. POSIX only.
+int process_reap(process_type process, reproc_usage *usage);
+
+// Opens a pipe that becomes readable once `process` exits. Unlike the exit pipe
+// passed to `process_start`, it isn't inherited by the descendants of
+// `process`. Linux only.
+int process_exit(process_type process, pipe_type *exited);
 
 // Sends the `SIGTERM` (POSIX) or `CTRL-BREAK` (Windows) signal to the process
-// indicated by `process`.
-int process_terminate(process_type process);
+// indicated by `process`. If `group` is true, the signal is sent to the process
+// group of `process` instead (POSIX only).
+int process_terminate(process_type process, bool group);
 
 // Sends the `SIGKILL` signal to `process` (POSIX) or calls `TerminateProcess`
-// on `process` (Windows).
-int process_kill(process_type process);
+// on `process` (Windows). If `group` is true, the signal is sent to the process
+// group of `process` instead (POSIX only).
+int process_kill(process_type process, bool group);
 
 process_type process_destroy(process_type process);
@@ -1,19 +1,29 @@
 #define _POSIX_C_SOURCE 200809L
+// `wait4` isn't part of POSIX.
+#define _DEFAULT_SOURCE
+#define _DARWIN_C_SOURCE
 
 #include "process.h"
 
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/resource.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+  #include <sys/syscall.h>
+#endif
+
 #include "error.h"
 #include "macro.h"
+#include "path.h"
 #include "pipe.h"
 #include "strv.h"
 
@@ -100,6 +110,102 @@ static char *path_prepend_cwd(const char *path)
   return cwd;
 }
 
+// Returns the value of the environment variable `name` in `env` or `NULL` if
+// `env` does not contain `name`. Just like `getenv`, the first match is used.
+static const char *env_get(char *const *env, const char *name)
+{
+  size_t size = strlen(name);
+  char *const *i = NULL;
+
+  STRV_FOREACH(i, env) {
+    if (strncmp(*i, name, size) == 0 && (*i)[size] == '=') {
+      return *i + size + 1;
+    }
+  }
+
+  return NULL;
+}
+
+// Used by `execvp` when PATH is not set.
+static const char *const DEFAULT_PATH = "/bin:/usr/bin";
+
+// Calls `execve` and, just like `execvp`, runs `file` with /bin/sh if it isn't
+// in a recognized executable format. `script` must have space for two more
+// elements than `argv`. Only returns if an error occurs.
+static void exec_file(const char *file,
+                      const char *const *argv,
+                      char *const *envp,
+                      const char **script)
+{
+  execve(file, (char *const *) argv, envp);
+
+  if (errno != ENOEXEC) {
+    return;
+  }
+
+  size_t i = 0;
+  script[i++] = "/bin/sh";
+  script[i++] = file;
+
+  for (const char *const *arg = argv + 1; *arg != NULL; arg++) {
+    script[i++] = *arg;
+  }
+
+  script[i] = NULL;
+
+  execve(script[0], (char *const *) script, envp);
+
+  errno = ENOEXEC;
+}
+
+// Searches `path` for `program` and executes it in the same way as `execvp`
+// except that it does not allocate memory. `buffer` must be large enough to
+// hold any directory in `path` followed by a slash and `program`. Only returns
+// if an error occurs.
+static int exec_search(const char *program,
+                       const char *path,
+                       const char *const *argv,
+                       char *const *envp,
+                       char *buffer,
+                       const char **script)
+{
+  size_t program_size = strlen(program);
+  bool eacces = false;
+
+  for (const char *dir = path; dir != NULL;) {
+    const char *end = strchr(dir, ':');
+    size_t size = end == NULL ? strlen(dir) : (size_t) (end - dir);
+
+    // An empty directory refers to the current working directory.
+    memcpy(buffer, dir, size);
+    if (size > 0) {
+      buffer[size++] = '/';
+    }
+
+    memcpy(buffer + size, program, program_size + 1);
+
+    exec_file(buffer, argv, envp, script);
+
+    switch (errno) {
+      case EACCES:
+        eacces = true;
+        break;
+      case ENOENT:
+      case ENOTDIR:
+      case ENODEV:
+      case ESTALE:
+      case ETIMEDOUT:
+        break;
+      default:
+        return -errno;
+    }
+
+    dir = end == NULL ? NULL : end + 1;
+  }
+
+  return eacces ? -EACCES : -ENOENT;
+}
+
 static const int MAX_FD_LIMIT = 1024 * 1024;
 
 static int get_max_fd(void)
@@ -131,6 +237,20 @@ static bool fd_in_set(int fd, const int *fd_set, size_t size)
   return false;
 }
 
+// Moves `*fd` to a file descriptor of at least `min` with `FD_CLOEXEC` set. The
+// original file descriptor is left open.
+static int fd_move(int *fd, int min)
+{
+  int r = fcntl(*fd, F_DUPFD_CLOEXEC, min);
+  if (r < 0) {
+    return -errno;
+  }
+
+  *fd = r;
+
+  return 0;
+}
+
 static pid_t process_fork(const int *except, size_t num_except)
 {
   struct {
@@ -300,6 +420,172 @@ finish:
   return 0;
 }
 
+static rlim_t rlim_from(uint64_t limit)
+{
+  return limit == REPROC_LIMIT_INFINITY || limit > (rlim_t) RLIM_INFINITY
+             ? RLIM_INFINITY
+             : (rlim_t) limit;
+}
+
+static int limit_apply(int resource, reproc_limit limit)
+{
+  if (!limit.set) {
+    return 0;
+  }
+
+  struct rlimit rlimit = { .rlim_cur = rlim_from(limit.soft),
+                           .rlim_max = rlim_from(limit.hard) };
+
+  int r = setrlimit(resource, &rlimit);
+  return r < 0 ? -errno : 0;
+}
+
+static int limits_apply(reproc_limits limits)
+{
+  struct {
+    int resource;
+    reproc_limit limit;
+  } table[] = {
+    { RLIMIT_AS, limits.as },       { RLIMIT_CPU, limits.cpu },
+    { RLIMIT_NOFILE, limits.nofile },
+#if defined(RLIMIT_NPROC)
+    { RLIMIT_NPROC, limits.nproc },
+#endif
+    { RLIMIT_CORE, limits.core },   { RLIMIT_FSIZE, limits.fsize },
+  };
+
+  for (size_t i = 0; i < ARRAY_SIZE(table); i++) {
+    int r = limit_apply(table[i].resource, table[i].limit);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  return 0;
+}
+
+#if defined(__linux__)
+// Affinity and node masks are passed to the kernel as arrays of unsigned longs.
+// 1024 bits matches glibc's `CPU_SETSIZE`.
+  #define MASK_BITS 1024
+  #define WORD_BITS (8 * sizeof(unsigned long))
+
+// `sched.h` only defines these with `_GNU_SOURCE`.
+  #if !defined(SCHED_BATCH)
+    #define SCHED_BATCH 3
+  #endif
+  #if !defined(SCHED_IDLE)
+    #define SCHED_IDLE 5
+  #endif
+
+static const int SCHED[] = {
+  [REPROC_SCHED_OTHER] = SCHED_OTHER, [REPROC_SCHED_BATCH] = SCHED_BATCH,
+  [REPROC_SCHED_IDLE] = SCHED_IDLE,   [REPROC_SCHED_FIFO] = SCHED_FIFO,
+  [REPROC_SCHED_RR] = SCHED_RR,
+};
+
+// Values of `MPOL_*` from `linux/mempolicy.h`, which isn't always installed.
+static const int MEMPOLICY[] = {
+  [REPROC_MEMPOLICY_DEFAULT] = 0,    [REPROC_MEMPOLICY_PREFERRED] = 1,
+  [REPROC_MEMPOLICY_BIND] = 2,       [REPROC_MEMPOLICY_INTERLEAVE] = 3,
+  [REPROC_MEMPOLICY_LOCAL] = 4,
+};
+
+// `linux/ioprio.h` isn't always installed either.
+  #define IOPRIO_WHO_PROCESS 1
+  #define IOPRIO_CLASS_SHIFT 13
+
+static int mask_from(const int *bits, size_t size, unsigned long *mask)
+{
+  memset(mask, 0, MASK_BITS / 8);
+
+  for (size_t i = 0; i < size; i++) {
+    if (bits[i] >= MASK_BITS) {
+      return -EINVAL;
+    }
+
+    size_t bit = (size_t) bits[i];
+    mask[bit / WORD_BITS] |= 1UL << (bit % WORD_BITS);
+  }
+
+  return 0;
+}
+#endif
+
+static int scheduling_apply(reproc_scheduling scheduling)
+{
+  int r = -1;
+
+#if defined(__linux__)
+  unsigned long mask[MASK_BITS / WORD_BITS];
+
+  if (scheduling.memory.policy != REPROC_MEMPOLICY_INHERIT) {
+    r = mask_from(scheduling.memory.nodes, scheduling.memory.size, mask);
+    if (r < 0) {
+      return r;
+    }
+
+    bool nodes = scheduling.memory.size > 0;
+    // The kernel ignores the last bit of the mask which is why we pass one
+    // more than the actual size.
+    r = (int) syscall(SYS_set_mempolicy, MEMPOLICY[scheduling.memory.policy],
+                      nodes ? mask : NULL, nodes ? MASK_BITS + 1 : 0);
+    if (r < 0) {
+      return -errno;
+    }
+  }
+
+  if (scheduling.affinity.size > 0) {
+    r = mask_from(scheduling.affinity.cpus, scheduling.affinity.size, mask);
+    if (r < 0) {
+      return r;
+    }
+
+    r = (int) syscall(SYS_sched_setaffinity, 0, MASK_BITS / 8, mask);
+    if (r < 0) {
+      return -errno;
+    }
+  }
+
+  if (scheduling.cpu.policy != REPROC_SCHED_INHERIT) {
+    struct sched_param param = { .sched_priority = scheduling.cpu.priority };
+
+    r = sched_setscheduler(0, SCHED[scheduling.cpu.policy], &param);
+    if (r < 0) {
+      return -errno;
+    }
+  }
+
+  if (scheduling.io.type != REPROC_IOPRIO_INHERIT) {
+    int ioprio = (int) scheduling.io.type << IOPRIO_CLASS_SHIFT |
+                 scheduling.io.level;
+
+    r = (int) syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, ioprio);
+    if (r < 0) {
+      return -errno;
+    }
+  }
+#else
+  if (scheduling.affinity.size > 0 ||
+      scheduling.memory.policy != REPROC_MEMPOLICY_INHERIT ||
+      scheduling.cpu.policy != REPROC_SCHED_INHERIT ||
+      scheduling.io.type != REPROC_IOPRIO_INHERIT) {
+    return -ENOTSUP;
+  }
+#endif
+
+  // Applied after the scheduling policy because switching to `SCHED_OTHER`
+  // from a realtime policy doesn't preserve the nice value on every system.
+  if (scheduling.nice.set) {
+    r = setpriority(PRIO_PROCESS, 0, scheduling.nice.value);
+    if (r < 0) {
+      return -errno;
+    }
+  }
+
+  return 0;
+}
+
 int process_start(pid_t *process,
                   const char *const *argv,
                   struct process_options options)
@@ -315,7 +601,11 @@ int process_start(pid_t *process,
     int write;
   } pipe = { PIPE_INVALID, PIPE_INVALID };
   char *program = NULL;
+  char *resolved = NULL;
   char **env = NULL;
+  const char *path = NULL;
+  char *buffer = NULL;
+  const char **script = NULL;
   int r = -1;
 
   // We create an error pipe to receive errors from the child process.
@@ -342,18 +632,122 @@ int process_start(pid_t *process,
                                                                  : environ;
   env = strv_concat(parent, options.env.extra);
   if (env == NULL) {
+    r = -errno;
     goto finish;
   }
 
-  int except[] = { options.handle.in, options.handle.out, options.handle.err,
-                   pipe.read,         pipe.write,         options.handle.exit };
+  if (argv != NULL) {
+    // The child process searches its own PATH so we do the same.
+    path = env_get(env, "PATH");
+
+    // Search PATH in the parent so the child process only has to call `exec`
+    // once.
+    r = path_resolve(program, path, options.path_cache, &resolved);
+    if (r < 0) {
+      goto finish;
+    }
+
+    // Everything the child process needs to call `exec` is allocated up front
+    // so the child process doesn't have to allocate memory or modify global
+    // state.
+
+    if (strchr(program, '/') == NULL) {
+      path = path == NULL ? DEFAULT_PATH : path;
+
+      buffer = malloc(strlen(path) + strlen(program) + 2);
+      if (buffer == NULL) {
+        r = -errno;
+        goto finish;
+      }
+    } else {
+      path = NULL;
+    }
+
+    size_t argc = 0;
+    while (argv[argc] != NULL) {
+      argc++;
+    }
+
+    script = calloc(argc + 2, sizeof(const char *));
+    if (script == NULL) {
+      r = -errno;
+      goto finish;
+    }
+  }
+
+  int except[7 + PROCESS_EXTRA_MAX] = {
+    options.handle.in, options.handle.out,  options.handle.err,
+    pipe.read,         pipe.write,          options.handle.exit,
+    options.cgroup
+  };
+  size_t num_except = 7;
+  int top = 0;
+
+  for (size_t i = 0; i < PROCESS_EXTRA_MAX; i++) {
+    if (options.extra[i].fd != 0) {
+      except[num_except++] = options.extra[i].handle;
+      top = options.extra[i].fd >= top ? options.extra[i].fd + 1 : top;
+    }
+  }
 
-  r = process_fork(except, ARRAY_SIZE(except));
+  r = process_fork(except, num_except);
   if (r < 0) {
     goto finish;
   }
 
   if (r == 0) {
+    // Join the cgroup first so everything the child process does is accounted
+    // to the cgroup.
+    if (options.cgroup != CGROUP_INVALID) {
+      r = cgroup_enter(options.cgroup);
+      if (r < 0) {
+        errno = -r;
+        goto child;
+      }
+    }
+
+    // A new session also starts a new process group. Either way, the process
+    // group ID is the child process ID which `process_terminate` and
+    // `process_kill` rely on to signal the entire group.
+    if (options.session) {
+      r = setsid();
+      if (r < 0) {
+        r = -errno;
+        goto child;
+      }
+    } else if (options.process_group) {
+      r = setpgid(0, 0);
+      if (r < 0) {
+        r = -errno;
+        goto child;
+      }
+    }
+
+    // Installing the extra file descriptors might overwrite handles we still
+    // need so we move those above the highest extra file descriptor first.
+    if (top > 0) {
+      r = fd_move(&pipe.write, top);
+      if (r < 0) {
+        goto child;
+      }
+
+      r = fd_move(&options.handle.exit, top);
+      if (r < 0) {
+        goto child;
+      }
+
+      for (size_t i = 0; i < PROCESS_EXTRA_MAX; i++) {
+        if (options.extra[i].fd == 0) {
+          continue;
+        }
+
+        r = fd_move(&options.extra[i].handle, top);
+        if (r < 0) {
+          goto child;
+        }
+      }
+    }
+
     // Redirect stdin, stdout and stderr.
 
     int redirect[] = { options.handle.in, options.handle.out,
@@ -380,6 +774,29 @@ int process_start(pid_t *process,
       }
     }
 
+    if (options.terminal > 0) {
+      r = ioctl(options.terminal, TIOCSCTTY, 0);
+      if (r < 0) {
+        r = -errno;
+        goto child;
+      }
+    }
+
+    // `dup2` doesn't copy `FD_CLOEXEC` so the extra file descriptors are
+    // inherited.
+
+    for (size_t i = 0; i < PROCESS_EXTRA_MAX; i++) {
+      if (options.extra[i].fd == 0) {
+        continue;
+      }
+
+      r = dup2(options.extra[i].handle, options.extra[i].fd);
+      if (r < 0) {
+        r = -errno;
+        goto child;
+      }
+    }
+
     // Make sure the `exit` file descriptor is inherited.
 
     r = handle_cloexec(options.handle.exit, false);
@@ -395,20 +812,42 @@ int process_start(pid_t *process,
       }
     }
 
-    // `environ` is carried over calls to `exec`.
-    environ = env;
+    r = limits_apply(options.limits);
+    if (r < 0) {
+      goto child;
+    }
 
-    if (argv != NULL) {
+    r = scheduling_apply(options.scheduling);
+    if (r < 0) {
+      goto child;
+    }
+
+    if (argv == NULL) {
+      // Without `exec`, the caller's code keeps running in the child process
+      // so `environ` is the only way to hand it the new environment.
+      environ = env;
+      env = NULL;
+    } else {
       ASSERT(program);
 
-      r = execvp(program, (char *const *) argv);
-      if (r < 0) {
+      if (resolved != NULL) {
+        // If this fails, the executable was made inaccessible without
+        // modifying its directory. Fall back to searching PATH which also takes
+        // care of reporting the error.
+        exec_file(resolved, argv, env, script);
+      }
+
+      if (path != NULL) {
+        r = exec_search(program, path, argv, env, buffer, script);
+      } else {
+        exec_file(program, argv, env, script);
         r = -errno;
-        goto child;
       }
-    }
 
-    env = NULL;
+      // `errno` is what we send to the parent process.
+      errno = -r;
+      goto child;
+    }
 
   child:
     if (r < 0) {
@@ -419,6 +858,9 @@ int process_start(pid_t *process,
     pipe_destroy(pipe.read);
     pipe_destroy(pipe.write);
     free(program);
+    free(resolved);
+    free(buffer);
+    free(script);
     strv_free(env);
 
     return 0;
@@ -447,6 +889,9 @@ finish:
   pipe_destroy(pipe.read);
   pipe_destroy(pipe.write);
   free(program);
+  free(resolved);
+  free(buffer);
+  free(script);
   strv_free(env);
 
   return r < 0 ? r : 1;
@@ -462,37 +907,105 @@ int process_pid(process_type process)
   return process;
 }
 
-int process_wait(pid_t process)
+static int64_t timeval_us(struct timeval timeval)
+{
+  return (int64_t) timeval.tv_sec * 1000000 + timeval.tv_usec;
+}
+
+static int process_wait4(pid_t process, int options, reproc_usage *usage)
 {
   ASSERT(process != PROCESS_INVALID);
+  ASSERT(usage);
 
+  struct rusage rusage = { 0 };
   int status = 0;
-  int r = waitpid(process, &status, 0);
+
+  // Unlike `getrusage(RUSAGE_CHILDREN)`, `wait4` reports the usage of this
+  // specific child process.
+  int r = wait4(process, &status, options, &rusage);
   if (r < 0) {
     return -errno;
   }
 
+  if (r == 0) {
+    return -EAGAIN;
+  }
+
   ASSERT(r == process);
 
+  *usage = (reproc_usage){
+    .utime = timeval_us(rusage.ru_utime),
+    .stime = timeval_us(rusage.ru_stime),
+#if defined(__APPLE__)
+    .maxrss = (int64_t) rusage.ru_maxrss,
+#else
+    // Linux and the BSDs report the maximum resident set size in kilobytes.
+    .maxrss = (int64_t) rusage.ru_maxrss * 1024,
+#endif
+    .majflt = rusage.ru_majflt,
+    .nvcsw = rusage.ru_nvcsw,
+    .nivcsw = rusage.ru_nivcsw,
+    .inblock = rusage.ru_inblock,
+    .oublock = rusage.ru_oublock
+  };
+
   return parse_status(status);
 }
 
-int process_terminate(pid_t process)
+int process_wait(pid_t process, reproc_usage *usage)
+{
+  return process_wait4(process, 0, usage);
+}
+
+int process_reap(pid_t process, reproc_usage *usage)
+{
+  return process_wait4(process, WNOHANG, usage);
+}
+
+int process_exit(pid_t process, int *exited)
 {
   ASSERT(process != PROCESS_INVALID);
+  ASSERT(exited);
 
-  int r = kill(process, SIGTERM);
-  return r < 0 ? -errno : 0;
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  // A pidfd becomes readable when the process exits and is always cloexec.
+  int r = (int) syscall(SYS_pidfd_open, process, 0);
+  if (r < 0) {
+    return -errno;
+  }
+
+  *exited = r;
+
+  return 0;
+#else
+  (void) exited;
+  return -ENOSYS;
+#endif
 }
 
-int process_kill(pid_t process)
+static int process_signal(pid_t process, bool group, int signal)
 {
   ASSERT(process != PROCESS_INVALID);
 
-  int r = kill(process, SIGKILL);
+  int r = kill(group ? -process : process, signal);
+  // The process group disappears once all its processes have exited.
+  if (r < 0 && group && errno == ESRCH) {
+    return 0;
+  }
+
   return r < 0 ? -errno : 0;
 }
 
+int process_terminate(pid_t process, bool group)
+{
+  return process_signal(process, group, SIGTERM);
+}
+
+int process_kill(pid_t process, bool group)
+{
+  return process_signal(process, group, SIGKILL);
+}
+
 pid_t process_destroy(pid_t process)
 {
   // `waitpid` already cleans up the process for us.
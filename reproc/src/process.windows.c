@@ -10,6 +10,8 @@
 #include <stdlib.h>
 #include <windows.h>
 
+#include <psapi.h>
+
 #include "error.h"
 #include "macro.h"
 #include "utf.h"
@@ -321,13 +323,39 @@ finish:
   return env_wstring;
 }
 
+static bool limits_set(reproc_limits limits)
+{
+  return limits.as.set || limits.cpu.set || limits.nofile.set ||
+         limits.nproc.set || limits.core.set || limits.fsize.set;
+}
+
+static bool scheduling_set(reproc_scheduling scheduling)
+{
+  return scheduling.affinity.size > 0 ||
+         scheduling.memory.policy != REPROC_MEMPOLICY_INHERIT ||
+         scheduling.nice.set || scheduling.cpu.policy != REPROC_SCHED_INHERIT ||
+         scheduling.io.type != REPROC_IOPRIO_INHERIT;
+}
+
+static bool extra_set(struct process_options options)
+{
+  for (size_t i = 0; i < PROCESS_EXTRA_MAX; i++) {
+    if (options.extra[i].fd != 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 int process_start(HANDLE *process,
                   const char *const *argv,
                   struct process_options options)
 {
   ASSERT(process);
 
-  if (argv == NULL) {
+  if (argv == NULL || limits_set(options.limits) ||
+      scheduling_set(options.scheduling) || extra_set(options)) {
     return -ERROR_CALL_NOT_IMPLEMENTED;
   }
 
@@ -453,9 +481,52 @@ int process_pid(process_type process)
   return (int) GetProcessId(process);
 }
 
-int process_wait(HANDLE process)
+static int64_t filetime_us(FILETIME filetime)
+{
+  uint64_t time = (uint64_t) filetime.dwHighDateTime << 32 |
+                  filetime.dwLowDateTime;
+
+  // `FILETIME` is expressed in 100-nanosecond intervals.
+  return (int64_t) (time / 10);
+}
+
+static int process_usage(HANDLE process, reproc_usage *usage)
+{
+  FILETIME creation = { 0 };
+  FILETIME exited = { 0 };
+  FILETIME kernel = { 0 };
+  FILETIME user = { 0 };
+  IO_COUNTERS io = { 0 };
+  PROCESS_MEMORY_COUNTERS memory = { .cb = sizeof(memory) };
+
+  BOOL r = GetProcessTimes(process, &creation, &exited, &kernel, &user);
+  if (r == 0) {
+    return -(int) GetLastError();
+  }
+
+  r = GetProcessIoCounters(process, &io);
+  if (r == 0) {
+    return -(int) GetLastError();
+  }
+
+  r = GetProcessMemoryInfo(process, &memory, sizeof(memory));
+  if (r == 0) {
+    return -(int) GetLastError();
+  }
+
+  *usage = (reproc_usage){ .utime = filetime_us(user),
+                           .stime = filetime_us(kernel),
+                           .maxrss = (int64_t) memory.PeakWorkingSetSize,
+                           .inblock = (int64_t) io.ReadOperationCount,
+                           .oublock = (int64_t) io.WriteOperationCount };
+
+  return 0;
+}
+
+int process_wait(HANDLE process, reproc_usage *usage)
 {
   ASSERT(process);
+  ASSERT(usage);
 
   int r = -1;
 
@@ -470,6 +541,11 @@ int process_wait(HANDLE process)
     return -(int) GetLastError();
   }
 
+  r = process_usage(process, usage);
+  if (r < 0) {
+    return r;
+  }
+
   // `GenerateConsoleCtrlEvent` causes a process to exit with this exit code.
   // Because `GenerateConsoleCtrlEvent` has roughly the same semantics as
   // `SIGTERM`, we map its exit code to `SIGTERM`.
@@ -480,10 +556,21 @@ int process_wait(HANDLE process)
   return (int) status;
 }
 
-int process_terminate(HANDLE process)
+int process_exit(HANDLE process, pipe_type *exited)
+{
+  ASSERT(process && process != PROCESS_INVALID);
+  ASSERT(exited);
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int process_terminate(HANDLE process, bool group)
 {
   ASSERT(process && process != PROCESS_INVALID);
 
+  // The child process is always the leader of its own process group.
+  (void) group;
+
   // `GenerateConsoleCtrlEvent` can only be called on a process group. To call
   // `GenerateConsoleCtrlEvent` on a single child process it has to be put in
   // its own process group (which we did when starting the child process).
@@ -492,10 +579,13 @@ int process_terminate(HANDLE process)
   return r == 0 ? -(int) GetLastError() : 0;
 }
 
-int process_kill(HANDLE process)
+int process_kill(HANDLE process, bool group)
 {
   ASSERT(process && process != PROCESS_INVALID);
 
+  // Killing the descendants of the child process requires job objects.
+  (void) group;
+
   // We use 137 (`SIGKILL`) as the exit status because it is the same exit
   // status as a process that is stopped with the `SIGKILL` signal on POSIX
   // systems.
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <reproc/reproc.h>
+
+#include "handle.h"
+#include "pipe.h"
+
+// Opens the file at `path` for reading and positions it at `offset`.
+int pump_open(const char *path, uint64_t offset, handle_type *file);
+
+// Duplicates `handle` so it remains valid if the caller closes `handle`.
+int pump_dup(reproc_handle handle, handle_type *file);
+
+// Writes up to `size` bytes of `file` starting at `*offset` to `pipe` and
+// advances `*offset` by the amount of bytes written. The current position of
+// `file` is ignored. Where possible, the data is moved to `pipe` without
+// copying it to user space. Returns the amount of bytes written or 0 if the end
+// of `file` was reached. `pipe` should be in nonblocking mode.
+int pump_file(pipe_type pipe,
+              handle_type file,
+              uint64_t *offset,
+              uint64_t size);
+
+// Copies up to `size` bytes from the pipe `from` to the pipe `to` without
+// consuming them from `from`. Returns the amount of bytes copied or 0 if `from`
+// is closed and empty. Returns `REPROC_EWOULDBLOCK` if `from` is empty or `to`
+// is full.
+//
+// Linux only.
+int pump_tee(pipe_type from, pipe_type to, size_t size);
+
+// Stores the amount of bytes that can be written to `pipe` without blocking in
+// `space`.
+//
+// Linux only.
+int pump_space(pipe_type pipe, size_t *space);
+
+// Moves up to `size` bytes from the pipe `from` to `to`, consuming them from
+// `from`. Returns the amount of bytes moved or 0 if `from` is closed and empty.
+// Returns `REPROC_EWOULDBLOCK` if `from` is empty or `to` is full.
+//
+// Linux only.
+int pump_splice(pipe_type from, pipe_type to, size_t size);
@@ -0,0 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+// `splice` isn't part of POSIX.
+#define _GNU_SOURCE
+
+#include "pump.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "error.h"
+
+enum { BUFFER_SIZE = 65536 };
+
+int pump_open(const char *path, uint64_t offset, int *file)
+{
+  ASSERT(path);
+  ASSERT(file);
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -errno;
+  }
+
+  if (offset > 0 && lseek(fd, (off_t) offset, SEEK_SET) < 0) {
+    int r = -errno;
+    handle_destroy(fd);
+    return r;
+  }
+
+  *file = fd;
+
+  return 0;
+}
+
+int pump_dup(int handle, int *file)
+{
+  ASSERT(file);
+
+  int r = fcntl(handle, F_DUPFD_CLOEXEC, 0);
+  if (r < 0) {
+    return -errno;
+  }
+
+  *file = r;
+
+  return 0;
+}
+
+int pump_file(int pipe, int file, uint64_t *offset, uint64_t size)
+{
+  ASSERT(pipe != PIPE_INVALID);
+  ASSERT(file != HANDLE_INVALID);
+  ASSERT(offset);
+
+  size_t chunk = size > BUFFER_SIZE ? BUFFER_SIZE : (size_t) size;
+
+#if defined(__linux__)
+  loff_t position = (loff_t) *offset;
+
+  ssize_t spliced = splice(file, &position, pipe, NULL, chunk,
+                           SPLICE_F_NONBLOCK);
+  if (spliced >= 0) {
+    *offset = (uint64_t) position;
+    return (int) spliced;
+  }
+
+  // `splice` fails with `EINVAL` if `file` doesn't support it, in which case
+  // we fall back to copying the data ourselves.
+  if (errno != EINVAL) {
+    return -errno;
+  }
+#endif
+
+  uint8_t buffer[BUFFER_SIZE];
+
+  ssize_t bytes_read = pread(file, buffer, chunk, (off_t) *offset);
+  if (bytes_read <= 0) {
+    return bytes_read < 0 ? -errno : 0;
+  }
+
+  int r = pipe_write(pipe, buffer, (size_t) bytes_read);
+  if (r < 0) {
+    return r;
+  }
+
+  *offset += (uint64_t) r;
+
+  return r;
+}
+
+int pump_tee(int from, int to, size_t size)
+{
+  ASSERT(from != PIPE_INVALID);
+  ASSERT(to != PIPE_INVALID);
+
+#if defined(__linux__)
+  ssize_t r = tee(from, to, size, SPLICE_F_NONBLOCK);
+  return r < 0 ? -errno : (int) r;
+#else
+  (void) size;
+  return -ENOTSUP;
+#endif
+}
+
+int pump_space(int pipe, size_t *space)
+{
+  ASSERT(pipe != PIPE_INVALID);
+  ASSERT(space);
+
+#if defined(__linux__)
+  int capacity = fcntl(pipe, F_GETPIPE_SZ);
+  if (capacity < 0) {
+    return -errno;
+  }
+
+  // On Linux, `FIONREAD` also works on the write end of a pipe.
+  int used = 0;
+  if (ioctl(pipe, FIONREAD, &used) < 0) {
+    return -errno;
+  }
+
+  *space = capacity > used ? (size_t) (capacity - used) : 0;
+
+  return 0;
+#else
+  (void) space;
+  return -ENOTSUP;
+#endif
+}
+
+int pump_splice(int from, int to, size_t size)
+{
+  ASSERT(from != PIPE_INVALID);
+  ASSERT(to != PIPE_INVALID);
+
+#if defined(__linux__)
+  ssize_t r = splice(from, NULL, to, NULL, size, SPLICE_F_NONBLOCK);
+  return r < 0 ? -errno : (int) r;
+#else
+  (void) size;
+  return -ENOTSUP;
+#endif
+}
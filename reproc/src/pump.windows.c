@@ -0,0 +1,131 @@
+#ifndef _WIN32_WINNT
+  #define _WIN32_WINNT 0x0600 // _WIN32_WINNT_VISTA
+#elif _WIN32_WINNT < 0x0600
+  #error "_WIN32_WINNT must be greater than _WIN32_WINNT_VISTA (0x0600)"
+#endif
+
+#include "pump.h"
+
+#include <stdlib.h>
+#include <windows.h>
+
+#include "error.h"
+#include "utf.h"
+
+enum { BUFFER_SIZE = 65536 };
+
+int pump_open(const char *path, uint64_t offset, HANDLE *file)
+{
+  ASSERT(path);
+  ASSERT(file);
+
+  HANDLE handle = HANDLE_INVALID;
+  int r = -1;
+
+  wchar_t *wpath = utf16_from_utf8(path, -1);
+  if (wpath == NULL) {
+    r = -(int) GetLastError();
+    goto finish;
+  }
+
+  SECURITY_ATTRIBUTES do_not_inherit = { .nLength = sizeof(SECURITY_ATTRIBUTES),
+                                         .bInheritHandle = false,
+                                         .lpSecurityDescriptor = NULL };
+
+  handle = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                       &do_not_inherit, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                       NULL);
+  if (handle == INVALID_HANDLE_VALUE) {
+    r = -(int) GetLastError();
+    goto finish;
+  }
+
+  LARGE_INTEGER position = { .QuadPart = (LONGLONG) offset };
+
+  if (!SetFilePointerEx(handle, position, NULL, FILE_BEGIN)) {
+    r = -(int) GetLastError();
+    goto finish;
+  }
+
+  *file = handle;
+  handle = HANDLE_INVALID;
+  r = 0;
+
+finish:
+  free(wpath);
+  handle_destroy(handle);
+
+  return r;
+}
+
+int pump_dup(HANDLE handle, HANDLE *file)
+{
+  ASSERT(file);
+
+  BOOL r = DuplicateHandle(GetCurrentProcess(), handle, GetCurrentProcess(),
+                           file, 0, FALSE, DUPLICATE_SAME_ACCESS);
+
+  return r == 0 ? -(int) GetLastError() : 0;
+}
+
+int pump_file(pipe_type pipe, HANDLE file, uint64_t *offset, uint64_t size)
+{
+  ASSERT(pipe != PIPE_INVALID);
+  ASSERT(file != HANDLE_INVALID);
+  ASSERT(offset);
+
+  uint8_t buffer[BUFFER_SIZE];
+  DWORD chunk = size > BUFFER_SIZE ? BUFFER_SIZE : (DWORD) size;
+  DWORD bytes_read = 0;
+
+  // Passing an offset in `OVERLAPPED` reads from that offset regardless of the
+  // file pointer.
+  OVERLAPPED overlapped = { 0 };
+  overlapped.Offset = (DWORD) *offset;
+  overlapped.OffsetHigh = (DWORD) (*offset >> 32);
+
+  BOOL r = ReadFile(file, buffer, chunk, &bytes_read, &overlapped);
+  if (r == 0) {
+    DWORD error = GetLastError();
+    return error == ERROR_HANDLE_EOF ? 0 : -(int) error;
+  }
+
+  if (bytes_read == 0) {
+    return 0;
+  }
+
+  int written = pipe_write(pipe, buffer, bytes_read);
+  if (written < 0) {
+    return written;
+  }
+
+  *offset += (uint64_t) written;
+
+  return written;
+}
+
+int pump_tee(pipe_type from, pipe_type to, size_t size)
+{
+  (void) from;
+  (void) to;
+  (void) size;
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int pump_space(pipe_type pipe, size_t *space)
+{
+  (void) pipe;
+  (void) space;
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int pump_splice(pipe_type from, pipe_type to, size_t size)
+{
+  (void) from;
+  (void) to;
+  (void) size;
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <reproc/reproc.h>
+
+#include "pipe.h"
+#include "process.h"
+
+// The reaper keeps track of child processes so they can be reaped as soon as
+// they exit, even after their `reproc_t` instance was destroyed. Only child
+// processes started while the reaper is enabled are tracked.
+
+typedef struct reaper_entry *reaper_type;
+
+// Enables the reaper. If `thread` is true, a background thread reaps child
+// processes as soon as they exit.
+int reaper_start(bool thread);
+
+// Stops the background thread and stops tracking new child processes. Child
+// processes that are already tracked can still be reaped with `reaper_reap`.
+int reaper_stop(void);
+
+// Starts tracking `process` if the reaper is enabled and stores the entry
+// that tracks it in `entry`. If the reaper is disabled, `entry` is set to
+// `NULL`. `exit` is the exit pipe of `process` which is used if the system
+// can't watch `process` directly.
+int reaper_add(process_type process, pipe_type exit, reaper_type *entry);
+
+// Returns true if the process tracked by `entry` has already been reaped.
+bool reaper_reaped(reaper_type entry);
+
+// Returns the exit status of `process` and stops tracking it. If the reaper
+// hasn't reaped `process` yet or `entry` is `NULL`, this function waits for
+// `process` to exit.
+int reaper_wait(process_type process, reaper_type entry, reproc_usage *usage);
+
+// Calls `signal` with `process` and `group` unless the reaper already reaped
+// `process`, in which case its ID might belong to an unrelated process already
+// and 0 is returned instead. The reaper doesn't reap `process` while `signal`
+// runs.
+int reaper_signal(process_type process,
+                  reaper_type entry,
+                  bool group,
+                  int (*signal)(process_type process, bool group));
+
+// Tells the reaper that nobody is interested in the exit status of the process
+// tracked by `entry` anymore. The reaper stops tracking the process once it
+// has been reaped.
+void reaper_orphan(reaper_type entry);
+
+// Reaps every tracked child process that has exited. If none has, waits up to
+// `timeout` milliseconds for one to exit. Returns the amount of child
+// processes that were reaped.
+int reaper_reap(int timeout);
@@ -0,0 +1,485 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "reaper.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#if defined(REPROC_MULTITHREADED)
+  #include <pthread.h>
+#endif
+
+#include "error.h"
+#include "macro.h"
+
+struct reaper_entry {
+  pid_t process;
+  // Becomes readable once `process` exits. Set to `PIPE_INVALID` once it
+  // became readable without `process` having been reaped.
+  int exit;
+  bool reaped;
+  // Set if nobody is interested in the exit status of `process` anymore.
+  bool orphan;
+  // Set if the entry should be freed as soon as nobody is polling `exit`.
+  bool released;
+  // Set while `reaper_wait` waits for `process` without holding the lock. The
+  // reaper leaves `process` alone in the meantime.
+  bool waiting;
+  int status;
+  reproc_usage usage;
+  struct reaper_entry *next;
+};
+
+// An exit pipe becomes readable slightly before its process can be reaped and
+// stays readable afterwards. Processes whose exit pipe became readable are
+// checked at this interval (in milliseconds) until they can be reaped.
+static const int EXITING_INTERVAL = 10;
+
+static struct {
+  bool enabled;
+  struct reaper_entry *entries;
+  // Amount of threads polling the exit pipes of the entries without holding
+  // the lock. Entries are only freed while nobody is polling.
+  int polling;
+  // Written to whenever polling threads should rebuild their set of pipes.
+  struct {
+    int read;
+    int write;
+  } wake;
+#if defined(REPROC_MULTITHREADED)
+  bool stop;
+  bool running;
+  pthread_t thread;
+#endif
+} reaper = { .wake = { -1, -1 } };
+
+#if defined(REPROC_MULTITHREADED)
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void reaper_lock(void)
+{
+#if defined(REPROC_MULTITHREADED)
+  int r = pthread_mutex_lock(&mutex);
+  ASSERT_UNUSED(r == 0);
+#endif
+}
+
+static void reaper_unlock(void)
+{
+#if defined(REPROC_MULTITHREADED)
+  int r = pthread_mutex_unlock(&mutex);
+  ASSERT_UNUSED(r == 0);
+#endif
+}
+
+static void reaper_wake(void)
+{
+  const uint8_t byte = 0;
+
+  if (reaper.wake.write != PIPE_INVALID) {
+    // If the pipe is full, a wake up is already pending.
+    (void) !write(reaper.wake.write, &byte, sizeof(byte));
+  }
+}
+
+static void entry_release(struct reaper_entry *entry)
+{
+  entry->released = true;
+
+  if (reaper.polling > 0) {
+    // Another thread might be polling `exit`. The entry is freed by the first
+    // sweep after it's done.
+    return;
+  }
+
+  struct reaper_entry **link = &reaper.entries;
+  while (*link != entry) {
+    link = &(*link)->next;
+  }
+
+  *link = entry->next;
+  pipe_destroy(entry->exit);
+  free(entry);
+}
+
+// Reaps every tracked process that has exited and frees released entries.
+// Returns the amount of processes reaped.
+static int reaper_sweep(void)
+{
+  struct reaper_entry *next = NULL;
+  int reaped = 0;
+
+  for (struct reaper_entry *entry = reaper.entries; entry != NULL;
+       entry = next) {
+    next = entry->next;
+
+    if (!entry->reaped && !entry->released && !entry->waiting) {
+      int r = process_reap(entry->process, &entry->usage);
+      if (r >= 0) {
+        entry->reaped = true;
+        entry->status = r;
+        reaped++;
+      } else if (r == -ECHILD) {
+        // The process isn't our child, which happens in child processes
+        // started with `fork` that inherited the entries of their parent.
+        entry->reaped = true;
+        entry->orphan = true;
+      }
+    }
+
+    if (entry->released || (entry->reaped && entry->orphan)) {
+      entry_release(entry);
+    }
+  }
+
+  return reaped;
+}
+
+int reaper_reap(int timeout)
+{
+  pipe_event_source *sources = NULL;
+  size_t num_sources = 0;
+  bool exiting = false;
+  int r = -1;
+
+  reaper_lock();
+
+  r = reaper_sweep();
+  if (r != 0 || timeout == 0) {
+    goto finish;
+  }
+
+  // One extra source for the wake pipe.
+  size_t size = 1;
+
+  for (struct reaper_entry *entry = reaper.entries; entry != NULL;
+       entry = entry->next) {
+    size++;
+  }
+
+  sources = calloc(size, sizeof(pipe_event_source));
+  if (sources == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  if (reaper.wake.read != PIPE_INVALID) {
+    sources[num_sources++] = (pipe_event_source){ .pipe = reaper.wake.read,
+                                                  .interests = PIPE_EVENT_IN };
+  }
+
+  for (struct reaper_entry *entry = reaper.entries; entry != NULL;
+       entry = entry->next) {
+    if (entry->reaped || entry->released || entry->waiting) {
+      continue;
+    }
+
+    if (entry->exit == PIPE_INVALID) {
+      exiting = true;
+      continue;
+    }
+
+    sources[num_sources++] = (pipe_event_source){ .pipe = entry->exit,
+                                                  .interests = PIPE_EVENT_IN };
+  }
+
+  if (exiting && (timeout < 0 || timeout > EXITING_INTERVAL)) {
+    timeout = EXITING_INTERVAL;
+  }
+
+  if (num_sources == 0 && !exiting) {
+    // Nothing to wait for.
+    r = 0;
+    goto finish;
+  }
+
+  reaper.polling++;
+  reaper_unlock();
+
+  r = pipe_poll(sources, num_sources, timeout);
+
+  reaper_lock();
+  reaper.polling--;
+
+  if (r == -EINTR) {
+    r = 0;
+  }
+
+  if (r < 0) {
+    goto finish;
+  }
+
+  for (size_t i = 0; i < num_sources; i++) {
+    if (sources[i].events == 0) {
+      continue;
+    }
+
+    if (sources[i].pipe == reaper.wake.read) {
+      uint8_t buffer[64];
+      while (read(reaper.wake.read, buffer, sizeof(buffer)) > 0) {}
+      continue;
+    }
+
+    if (reaper.polling > 0) {
+      continue;
+    }
+
+    // Stop polling exit pipes that became readable so we don't spin on them.
+    // If the process can't be reaped yet, it's checked periodically instead.
+    for (struct reaper_entry *entry = reaper.entries; entry != NULL;
+         entry = entry->next) {
+      if (entry->exit == sources[i].pipe) {
+        entry->exit = pipe_destroy(entry->exit);
+      }
+    }
+  }
+
+  r = reaper_sweep();
+
+finish:
+  reaper_unlock();
+  free(sources);
+
+  return r;
+}
+
+#if defined(REPROC_MULTITHREADED)
+static void *reaper_main(void *context)
+{
+  (void) context;
+
+  for (;;) {
+    reaper_lock();
+    bool stop = reaper.stop;
+    reaper_unlock();
+
+    if (stop) {
+      break;
+    }
+
+    int r = reaper_reap(REPROC_INFINITE);
+    if (r < 0) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+#endif
+
+int reaper_start(bool thread)
+{
+  int r = 0;
+
+#if !defined(REPROC_MULTITHREADED)
+  if (thread) {
+    return -ENOTSUP;
+  }
+#endif
+
+  reaper_lock();
+
+  if (reaper.wake.read == PIPE_INVALID) {
+    r = pipe_init(&reaper.wake.read, &reaper.wake.write);
+    if (r < 0) {
+      goto finish;
+    }
+
+    r = pipe_nonblocking(reaper.wake.read, true);
+    if (r < 0) {
+      goto finish;
+    }
+
+    r = pipe_nonblocking(reaper.wake.write, true);
+    if (r < 0) {
+      goto finish;
+    }
+  }
+
+  reaper.enabled = true;
+
+#if defined(REPROC_MULTITHREADED)
+  if (thread && !reaper.running) {
+    reaper.stop = false;
+
+    // `pthread_create` returns positive errno values so we negate them.
+    r = -pthread_create(&reaper.thread, NULL, reaper_main, NULL);
+    if (r < 0) {
+      goto finish;
+    }
+
+    reaper.running = true;
+  }
+#endif
+
+finish:
+  reaper_unlock();
+
+  return r;
+}
+
+int reaper_stop(void)
+{
+  reaper_lock();
+
+  reaper.enabled = false;
+
+#if defined(REPROC_MULTITHREADED)
+  bool running = reaper.running;
+  reaper.stop = true;
+  reaper.running = false;
+#endif
+
+  reaper_wake();
+  reaper_unlock();
+
+#if defined(REPROC_MULTITHREADED)
+  if (running) {
+    int r = -pthread_join(reaper.thread, NULL);
+    if (r < 0) {
+      return r;
+    }
+  }
+#endif
+
+  return 0;
+}
+
+int reaper_add(pid_t process, int exit, reaper_type *entry)
+{
+  ASSERT(process != PROCESS_INVALID);
+  ASSERT(entry);
+
+  struct reaper_entry *added = NULL;
+  int r = 0;
+
+  *entry = NULL;
+
+  reaper_lock();
+
+  if (!reaper.enabled) {
+    goto finish;
+  }
+
+  added = calloc(1, sizeof(struct reaper_entry));
+  if (added == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  added->process = process;
+
+  // Prefer watching the process directly since its descendants might keep the
+  // exit pipe open.
+  r = process_exit(process, &added->exit);
+  if (r < 0) {
+    added->exit = fcntl(exit, F_DUPFD_CLOEXEC, 0);
+    if (added->exit < 0) {
+      r = -errno;
+      goto finish;
+    }
+  }
+
+  added->next = reaper.entries;
+  reaper.entries = added;
+  *entry = added;
+  added = NULL;
+  r = 0;
+
+  reaper_wake();
+
+finish:
+  reaper_unlock();
+  free(added);
+
+  return r;
+}
+
+bool reaper_reaped(reaper_type entry)
+{
+  if (entry == NULL) {
+    return false;
+  }
+
+  reaper_lock();
+  bool reaped = entry->reaped;
+  reaper_unlock();
+
+  return reaped;
+}
+
+int reaper_wait(pid_t process, reaper_type entry, reproc_usage *usage)
+{
+  ASSERT(usage);
+
+  if (entry == NULL) {
+    return process_wait(process, usage);
+  }
+
+  int r = -1;
+
+  reaper_lock();
+
+  if (entry->reaped) {
+    r = entry->status;
+    *usage = entry->usage;
+    entry_release(entry);
+    reaper_unlock();
+    return r;
+  }
+
+  // Don't block the reaper thread and `reaper_add` while we wait.
+  entry->waiting = true;
+  reaper_unlock();
+
+  r = process_wait(process, usage);
+
+  reaper_lock();
+  entry->waiting = false;
+
+  if (r >= 0) {
+    entry_release(entry);
+  }
+
+  reaper_unlock();
+
+  return r;
+}
+
+int reaper_signal(process_type process,
+                  reaper_type entry,
+                  bool group,
+                  int (*signal)(process_type process, bool group))
+{
+  ASSERT(signal);
+
+  if (entry == NULL) {
+    return signal(process, group);
+  }
+
+  reaper_lock();
+  int r = entry->reaped ? 0 : signal(process, group);
+  reaper_unlock();
+
+  return r;
+}
+
+void reaper_orphan(reaper_type entry)
+{
+  if (entry == NULL) {
+    return;
+  }
+
+  reaper_lock();
+
+  entry->orphan = true;
+
+  if (entry->reaped) {
+    entry_release(entry);
+  }
+
+  reaper_unlock();
+}
@@ -0,0 +1,55 @@
+#include "reaper.h"
+
+// Windows doesn't keep exited processes around once all handles to them are
+// closed, which `reproc_destroy` takes care of. There's nothing to reap.
+
+int reaper_start(bool thread)
+{
+  (void) thread;
+  return 0;
+}
+
+int reaper_stop(void)
+{
+  return 0;
+}
+
+int reaper_add(process_type process, pipe_type exit, reaper_type *entry)
+{
+  (void) process;
+  (void) exit;
+  *entry = NULL;
+  return 0;
+}
+
+bool reaper_reaped(reaper_type entry)
+{
+  (void) entry;
+  return false;
+}
+
+int reaper_wait(process_type process, reaper_type entry, reproc_usage *usage)
+{
+  (void) entry;
+  return process_wait(process, usage);
+}
+
+int reaper_signal(process_type process,
+                  reaper_type entry,
+                  bool group,
+                  int (*signal)(process_type process, bool group))
+{
+  (void) entry;
+  return signal(process, group);
+}
+
+void reaper_orphan(reaper_type entry)
+{
+  (void) entry;
+}
+
+int reaper_reap(int timeout)
+{
+  (void) timeout;
+  return 0;
+}
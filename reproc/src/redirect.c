@@ -37,6 +37,50 @@ finish:
   return r;
 }
 
+static int redirect_socketpair(pipe_type *parent,
+                               handle_type *child,
+                               reproc_redirect redirect,
+                               bool nonblocking)
+{
+  ASSERT(parent);
+  ASSERT(child);
+
+  int r = redirect_socket(parent, child, redirect);
+  if (r < 0) {
+    return r;
+  }
+
+  r = pipe_nonblocking(*parent, nonblocking);
+  if (r < 0) {
+    *parent = pipe_destroy(*parent);
+    *child = redirect_destroy(*child, REPROC_REDIRECT_SOCKET);
+  }
+
+  return r;
+}
+
+static int redirect_terminal(pipe_type *parent,
+                             handle_type *child,
+                             reproc_redirect redirect,
+                             bool nonblocking)
+{
+  ASSERT(parent);
+  ASSERT(child);
+
+  int r = redirect_pty(parent, child, redirect);
+  if (r < 0) {
+    return r;
+  }
+
+  r = pipe_nonblocking(*parent, nonblocking);
+  if (r < 0) {
+    *parent = pipe_destroy(*parent);
+    *child = redirect_destroy(*child, REPROC_REDIRECT_PTY);
+  }
+
+  return r;
+}
+
 int redirect_init(pipe_type *parent,
                   handle_type *child,
                   REPROC_STREAM stream,
@@ -59,6 +103,14 @@ int redirect_init(pipe_type *parent,
       r = redirect_pipe(parent, child, stream, nonblocking);
       break;
 
+    case REPROC_REDIRECT_SOCKET:
+      r = redirect_socketpair(parent, child, redirect, nonblocking);
+      break;
+
+    case REPROC_REDIRECT_PTY:
+      r = redirect_terminal(parent, child, redirect, nonblocking);
+      break;
+
     case REPROC_REDIRECT_PARENT:
       r = redirect_parent(child, stream);
       if (r == REPROC_EPIPE) {
@@ -144,6 +196,7 @@ handle_type redirect_destroy(handle_type child, REPROC_REDIRECT type)
       ASSERT(false);
       break;
     case REPROC_REDIRECT_PIPE:
+    case REPROC_REDIRECT_SOCKET:
       // We know `handle` is a pipe if `REDIRECT_PIPE` is used so the cast is
       // safe. This little hack prevents us from having to introduce a generic
       // handle type.
@@ -151,6 +204,7 @@ handle_type redirect_destroy(handle_type child, REPROC_REDIRECT type)
       break;
     case REPROC_REDIRECT_DISCARD:
     case REPROC_REDIRECT_PATH:
+    case REPROC_REDIRECT_PTY:
       handle_destroy(child);
       break;
     case REPROC_REDIRECT_PARENT:
@@ -12,6 +12,13 @@ int redirect_init(pipe_type *parent,
                   bool nonblocking,
                   handle_type out);
 
+// Makes `parent` and `child` new handles to the same socket as `in_parent` and
+// `in_child` so stdin and stdout of the child process share a single socket.
+int redirect_share(pipe_type *parent,
+                   handle_type *child,
+                   pipe_type in_parent,
+                   handle_type in_child);
+
 handle_type redirect_destroy(handle_type child, REPROC_REDIRECT type);
 
 // Internal prototypes
@@ -23,3 +30,11 @@ int redirect_discard(handle_type *child, REPROC_STREAM stream);
 int redirect_file(handle_type *child, FILE *file);
 
 int redirect_path(handle_type *child, REPROC_STREAM stream, const char *path);
+
+int redirect_socket(pipe_type *parent,
+                    handle_type *child,
+                    reproc_redirect redirect);
+
+int redirect_pty(pipe_type *parent,
+                 handle_type *child,
+                 reproc_redirect redirect);
@@ -1,12 +1,22 @@
 #define _POSIX_C_SOURCE 200809L
+// `posix_openpt` is an XSI extension and `TIOCSWINSZ` isn't part of POSIX.
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+#define _DARWIN_C_SOURCE
 
 #include "redirect.h"
 
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
 
 #include "error.h"
+#include "handle.h"
 #include "pipe.h"
 
 static FILE *stream_to_file(REPROC_STREAM stream)
@@ -77,3 +87,179 @@ int redirect_path(int *child, REPROC_STREAM stream, const char *path)
 
   return 0;
 }
+
+int redirect_socket(int *parent, int *child, reproc_redirect redirect)
+{
+  ASSERT(parent);
+  ASSERT(child);
+
+  int type = redirect.socket.seqpacket ? SOCK_SEQPACKET : SOCK_STREAM;
+  int pair[] = { PIPE_INVALID, PIPE_INVALID };
+  int r = -1;
+
+  r = socketpair(AF_UNIX, type, 0, pair);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    r = handle_cloexec(pair[i], true);
+    if (r < 0) {
+      goto finish;
+    }
+
+    if (redirect.socket.buffer == 0) {
+      continue;
+    }
+
+    int options[] = { SO_SNDBUF, SO_RCVBUF };
+
+    for (size_t j = 0; j < 2; j++) {
+      r = setsockopt(pair[i], SOL_SOCKET, options[j], &redirect.socket.buffer,
+                     sizeof(redirect.socket.buffer));
+      if (r < 0) {
+        r = -errno;
+        goto finish;
+      }
+    }
+  }
+
+  *parent = pair[0];
+  *child = pair[1];
+
+finish:
+  if (r < 0) {
+    pipe_destroy(pair[0]);
+    pipe_destroy(pair[1]);
+  }
+
+  return r;
+}
+
+int redirect_share(int *parent, int *child, int in_parent, int in_child)
+{
+  ASSERT(parent);
+  ASSERT(child);
+
+  int fds[] = { PIPE_INVALID, PIPE_INVALID };
+  int r = 0;
+
+  fds[0] = fcntl(in_parent, F_DUPFD_CLOEXEC, 0);
+  if (fds[0] < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  fds[1] = fcntl(in_child, F_DUPFD_CLOEXEC, 0);
+  if (fds[1] < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  *parent = fds[0];
+  *child = fds[1];
+
+finish:
+  if (r < 0) {
+    handle_destroy(fds[0]);
+    handle_destroy(fds[1]);
+  }
+
+  return r;
+}
+
+int redirect_pty(int *parent, int *child, reproc_redirect redirect)
+{
+  ASSERT(parent);
+  ASSERT(child);
+
+  int master = PIPE_INVALID;
+  int slave = HANDLE_INVALID;
+  int r = -1;
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = handle_cloexec(master, true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = grantpt(master);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = unlockpt(master);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+#if defined(TIOCGPTPEER)
+  // Unlike `ptsname`, this is thread-safe and doesn't depend on the path of the
+  // terminal in /dev/pts. Kernels older than 4.13 don't support it so we fall
+  // back to `ptsname` if it fails with `EINVAL` or `ENOTTY`.
+  slave = ioctl(master, TIOCGPTPEER, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (slave < 0 && errno != EINVAL && errno != ENOTTY) {
+    r = -errno;
+    goto finish;
+  }
+#endif
+
+  if (slave < 0) {
+    const char *name = ptsname(master);
+    slave = name == NULL ? -1 : open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  }
+
+  if (slave < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  // Don't translate "\n" to "\r\n" so the output matches the output written to
+  // a pipe.
+  struct termios termios;
+
+  r = tcgetattr(slave, &termios);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  termios.c_oflag &= ~(tcflag_t) ONLCR;
+
+  r = tcsetattr(slave, TCSANOW, &termios);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  struct winsize size = {
+    .ws_row = (unsigned short) (redirect.pty.rows ? redirect.pty.rows : 24),
+    .ws_col = (unsigned short) (redirect.pty.columns ? redirect.pty.columns
+                                                     : 80),
+  };
+
+  r = ioctl(master, TIOCSWINSZ, &size);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  *parent = master;
+  *child = slave;
+
+finish:
+  if (r < 0) {
+    pipe_destroy(master);
+    handle_destroy(slave);
+  }
+
+  return r;
+}
@@ -115,3 +115,33 @@ finish:
 
   return r;
 }
+
+int redirect_socket(SOCKET *parent, HANDLE *child, reproc_redirect redirect)
+{
+  (void) parent;
+  (void) child;
+  (void) redirect;
+
+  // Pipes are sockets on Windows already.
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int redirect_share(SOCKET *parent, HANDLE *child, SOCKET in_parent,
+                   HANDLE in_child)
+{
+  (void) parent;
+  (void) child;
+  (void) in_parent;
+  (void) in_child;
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int redirect_pty(SOCKET *parent, HANDLE *child, reproc_redirect redirect)
+{
+  (void) parent;
+  (void) child;
+  (void) redirect;
+
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
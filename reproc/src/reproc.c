@@ -1,19 +1,32 @@
 #include <reproc/reproc.h>
+#include <reproc/ring.h>
 
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "cgroup.h"
 #include "clock.h"
 #include "error.h"
 #include "handle.h"
 #include "init.h"
 #include "macro.h"
+#include "memfd.h"
 #include "options.h"
+#include "path.h"
 #include "pipe.h"
 #include "process.h"
+#include "pump.h"
+#include "reaper.h"
 #include "redirect.h"
+#include "ring.h"
+#include "strv.h"
 
 struct reproc_t {
   process_type handle;
+  cgroup_type cgroup;
+  reaper_type reaper;
 
   struct {
     pipe_type in;
@@ -23,14 +36,33 @@ struct reproc_t {
   } pipe;
 
   int status;
+  reproc_usage usage;
   reproc_stop_actions stop;
   int64_t deadline;
   bool nonblocking;
+  bool group;
 
   struct {
     pipe_type out;
     pipe_type err;
   } child;
+
+  // Input that is streamed to the stdin pipe, either from memory or from a
+  // file. See `input_write`.
+  struct {
+    const uint8_t *data;
+    handle_type file;
+    uint64_t offset;
+    uint64_t remaining;
+  } input;
+
+  // Pipes of `options.extra_fds`. See `extra_init`.
+  struct {
+    pipe_type pipe;
+    bool input;
+  } extra[REPROC_EXTRA_FDS_MAX];
+
+  ring_type ring;
 };
 
 enum {
@@ -47,37 +79,129 @@ const int REPROC_SIGTERM = SIGOFFSET + 15;
 const int REPROC_INFINITE = -1;
 const int REPROC_DEADLINE = -2;
 
-static int setup_input(pipe_type *pipe, const uint8_t *data, size_t size)
+const uint64_t REPROC_LIMIT_INFINITY = UINT64_MAX;
+
+// Prepares streaming stdin from `options->input`. If the child process can
+// read the file itself, `options->redirect.in` is changed to redirect stdin to
+// the file instead. `*direct` is set if we had to open the file for that, in
+// which case the caller has to close it once the child process started.
+static int setup_input(reproc_t *process,
+                       reproc_options *options,
+                       handle_type *direct)
 {
-  if (data == NULL) {
-    ASSERT(size == 0);
+  reproc_handle handle = options->input.file.handle;
+  const char *path = options->input.file.path;
+  uint64_t offset = options->input.file.offset;
+  uint64_t length = options->input.file.length;
+  int r = -1;
+
+  if (options->input.memfd) {
+    r = memfd_from(options->input.data, options->input.size, direct);
+    if (r < 0) {
+      return r;
+    }
+
+    handle = (reproc_handle) *direct;
+    options->redirect.in = (reproc_redirect){ .type = REPROC_REDIRECT_HANDLE,
+                                              .handle = handle };
     return 0;
   }
 
-  ASSERT(pipe && *pipe != PIPE_INVALID);
+  if (options->input.data != NULL) {
+    process->input.data = options->input.data;
+    process->input.remaining = options->input.size;
+    return 0;
+  }
 
-  // `reproc_write` only needs the child process stdin pipe to be initialized.
-  size_t written = 0;
-  int r = -1;
+  if (!handle && path == NULL) {
+    return 0;
+  }
+
+  if (length == 0 && (path != NULL || offset == 0)) {
+    if (path != NULL) {
+      r = pump_open(path, offset, direct);
+      if (r < 0) {
+        return r;
+      }
+
+      handle = (reproc_handle) *direct;
+    }
 
-  // Make sure we don't block indefinitely when `input` is bigger than the
-  // size of the pipe.
-  r = pipe_nonblocking(*pipe, true);
+    options->redirect.in = (reproc_redirect){ .type = REPROC_REDIRECT_HANDLE,
+                                              .handle = handle };
+    return 0;
+  }
+
+  r = path != NULL ? pump_open(path, 0, &process->input.file)
+                   : pump_dup(handle, &process->input.file);
   if (r < 0) {
     return r;
   }
 
-  while (written < size) {
-    r = pipe_write(*pipe, data + written, size - written);
+  process->input.offset = offset;
+  process->input.remaining = length == 0 ? UINT64_MAX : length;
+
+  return 0;
+}
+
+static bool input_pending(reproc_t *process)
+{
+  return process->input.data != NULL || process->input.file != HANDLE_INVALID;
+}
+
+// Writes as much of the pending input to the stdin pipe as possible without
+// blocking. Once all input has been written, the stdin pipe is closed.
+static int input_write(reproc_t *process)
+{
+  int r = 0;
+
+  if (!input_pending(process)) {
+    return 0;
+  }
+
+  // The caller didn't write the input so it can't be expected to ignore the
+  // `SIGPIPE` raised when the child process exits without reading all of it.
+  bool blocked = pipe_sigpipe_block();
+
+  while (process->input.remaining > 0) {
+    if (process->input.data != NULL) {
+      size_t size = process->input.remaining > INT_MAX
+                        ? INT_MAX
+                        : (size_t) process->input.remaining;
+      r = pipe_write(process->pipe.in,
+                     process->input.data + process->input.offset, size);
+      if (r > 0) {
+        process->input.offset += (uint64_t) r;
+      }
+    } else {
+      r = pump_file(process->pipe.in, process->input.file,
+                    &process->input.offset, process->input.remaining);
+    }
+
+    if (r == REPROC_EWOULDBLOCK) {
+      pipe_sigpipe_unblock(blocked);
+      return 0;
+    }
+
+    // If the child process closed its stdin, it's not interested in the rest
+    // of the input.
+    if (r == 0 || r == REPROC_EPIPE) {
+      break;
+    }
+
     if (r < 0) {
+      pipe_sigpipe_unblock(blocked);
       return r;
     }
 
-    ASSERT(written + (size_t) r <= size);
-    written += (size_t) r;
+    process->input.remaining -= (uint64_t) r;
   }
 
-  *pipe = pipe_destroy(*pipe);
+  pipe_sigpipe_unblock(blocked);
+
+  process->input.data = NULL;
+  process->input.file = handle_destroy(process->input.file);
+  process->pipe.in = pipe_destroy(process->pipe.in);
 
   return 0;
 }
@@ -147,17 +271,107 @@ reproc_t *reproc_new(void)
   }
 
   *process = (reproc_t){ .handle = PROCESS_INVALID,
+                         .cgroup = CGROUP_INVALID,
                          .pipe = { .in = PIPE_INVALID,
                                    .out = PIPE_INVALID,
                                    .err = PIPE_INVALID,
                                    .exit = PIPE_INVALID },
                          .child = { .out = PIPE_INVALID, .err = PIPE_INVALID },
                          .status = STATUS_NOT_STARTED,
-                         .deadline = REPROC_INFINITE };
+                         .deadline = REPROC_INFINITE,
+                         .input = { .file = HANDLE_INVALID } };
+
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    process->extra[i].pipe = PIPE_INVALID;
+  }
 
   return process;
 }
 
+// Creates a pipe for every entry of `extra` that doesn't pass a handle of its
+// own. The child endpoints are stored in `child` and have to be closed once the
+// child process has started.
+static int extra_init(reproc_t *process,
+                      const reproc_extra_fd *extra,
+                      bool nonblocking,
+                      handle_type *child)
+{
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    if (extra[i].fd == 0 || extra[i].handle) {
+      continue;
+    }
+
+    pipe_type read = PIPE_INVALID;
+    pipe_type write = PIPE_INVALID;
+
+    int r = pipe_init(&read, &write);
+    if (r < 0) {
+      return r;
+    }
+
+    process->extra[i].pipe = extra[i].input ? write : read;
+    process->extra[i].input = extra[i].input;
+    child[i] = (handle_type) (extra[i].input ? read : write);
+
+    r = pipe_nonblocking(process->extra[i].pipe, nonblocking);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  return 0;
+}
+
+static bool extra_used(const struct process_options *options, int fd)
+{
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    if (options->extra[i].fd == fd) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Passes the ring to the child process as the two lowest file descriptors that
+// aren't used by `extra_fds` and names them in the `REPROC_RING` environment
+// variable. `env` is set to the environment that has to be freed after starting
+// the child process.
+static int ring_pass(struct process_options *options,
+                     handle_type memory,
+                     handle_type doorbell,
+                     char ***env)
+{
+  int fds[] = { 0, 0 };
+  int fd = 3;
+
+  for (size_t i = 0; i < ARRAY_SIZE(fds); i++) {
+    while (extra_used(options, fd)) {
+      fd++;
+    }
+
+    fds[i] = fd++;
+  }
+
+  options->extra[REPROC_EXTRA_FDS_MAX].handle = memory;
+  options->extra[REPROC_EXTRA_FDS_MAX].fd = fds[0];
+  options->extra[REPROC_EXTRA_FDS_MAX + 1].handle = doorbell;
+  options->extra[REPROC_EXTRA_FDS_MAX + 1].fd = fds[1];
+
+  char value[64];
+  snprintf(value, sizeof(value), "REPROC_RING=%d,%d", fds[0], fds[1]);
+  const char *extra[] = { value, NULL };
+
+  *env = strv_concat((char *const *) options->env.extra, extra);
+  if (*env == NULL) {
+    return REPROC_ENOMEM;
+  }
+
+  options->env.extra = (const char *const *) *env;
+
+  return 0;
+}
+
 int reproc_start(reproc_t *process,
                  const char *const *argv,
                  reproc_options options)
@@ -170,9 +384,21 @@ int reproc_start(reproc_t *process,
     handle_type out;
     handle_type err;
     pipe_type exit;
-  } child = { HANDLE_INVALID, HANDLE_INVALID, HANDLE_INVALID, PIPE_INVALID };
+    handle_type extra[REPROC_EXTRA_FDS_MAX];
+    struct {
+      handle_type memory;
+      handle_type doorbell;
+    } ring;
+  } child = { HANDLE_INVALID, HANDLE_INVALID, HANDLE_INVALID, PIPE_INVALID,
+              { 0 },          { HANDLE_INVALID, HANDLE_INVALID } };
+  handle_type direct = HANDLE_INVALID;
+  char **env = NULL;
   int r = -1;
 
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    child.extra[i] = HANDLE_INVALID;
+  }
+
   r = init();
   if (r < 0) {
     return r; // Make sure we can always call `deinit` in `finish`.
@@ -183,14 +409,31 @@ int reproc_start(reproc_t *process,
     goto finish;
   }
 
+  r = cgroup_open(options.cgroup, &process->cgroup);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = setup_input(process, &options, &direct);
+  if (r < 0) {
+    goto finish;
+  }
+
   r = redirect_init(&process->pipe.in, &child.in, REPROC_STREAM_IN,
                     options.redirect.in, options.nonblocking, HANDLE_INVALID);
   if (r < 0) {
     goto finish;
   }
 
-  r = redirect_init(&process->pipe.out, &child.out, REPROC_STREAM_OUT,
-                    options.redirect.out, options.nonblocking, HANDLE_INVALID);
+  if (options.redirect.in.type == REPROC_REDIRECT_SOCKET &&
+      options.redirect.out.type == REPROC_REDIRECT_SOCKET) {
+    r = redirect_share(&process->pipe.out, &child.out, process->pipe.in,
+                       child.in);
+  } else {
+    r = redirect_init(&process->pipe.out, &child.out, REPROC_STREAM_OUT,
+                      options.redirect.out, options.nonblocking,
+                      HANDLE_INVALID);
+  }
   if (r < 0) {
     goto finish;
   }
@@ -206,20 +449,66 @@ int reproc_start(reproc_t *process,
     goto finish;
   }
 
-  r = setup_input(&process->pipe.in, options.input.data, options.input.size);
+  r = extra_init(process, options.extra_fds, options.nonblocking, child.extra);
   if (r < 0) {
     goto finish;
   }
 
+  if (options.ring.size > 0) {
+    r = ring_init(options.ring.size, &process->ring, &child.ring.memory,
+                  &child.ring.doorbell);
+    if (r < 0) {
+      goto finish;
+    }
+  }
+
+  if (input_pending(process)) {
+    r = pipe_nonblocking(process->pipe.in, true);
+    if (r < 0) {
+      goto finish;
+    }
+
+    // Fill the stdin pipe up front so the child process can start reading
+    // immediately. Small inputs are written completely here.
+    r = input_write(process);
+    if (r < 0) {
+      goto finish;
+    }
+  }
+
   struct process_options process_options = {
     .env = { .behavior = options.env.behavior, .extra = options.env.extra },
     .working_directory = options.working_directory,
+    .path_cache = !options.path_cache.disable,
+    .limits = options.limits,
+    .scheduling = options.scheduling,
+    .cgroup = process->cgroup,
+    .session = options.session,
+    .process_group = options.process_group,
+    .terminal = options.redirect.out.pty.controlling   ? 1
+                : options.redirect.err.pty.controlling ? 2
+                                                       : 0,
     .handle = { .in = child.in,
                 .out = child.out,
                 .err = child.err,
                 .exit = (handle_type) child.exit }
   };
 
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    reproc_extra_fd extra = options.extra_fds[i];
+    process_options.extra[i].fd = extra.fd;
+    process_options.extra[i].handle = extra.handle ? extra.handle
+                                                   : child.extra[i];
+  }
+
+  if (process->ring != NULL) {
+    r = ring_pass(&process_options, child.ring.memory, child.ring.doorbell,
+                  &env);
+    if (r < 0) {
+      goto finish;
+    }
+  }
+
   r = process_start(&process->handle, argv, process_options);
   if (r < 0) {
     goto finish;
@@ -233,6 +522,26 @@ int reproc_start(reproc_t *process,
     }
 
     process->nonblocking = options.nonblocking;
+#ifndef _WIN32
+    process->group = options.process_group || options.session;
+#endif
+
+    pipe_type exited = PIPE_INVALID;
+
+    // Descendants in the process group inherit the exit pipe which would keep
+    // us from noticing that the child process exited while they're still
+    // running. If the system can watch the child process directly, we use that
+    // instead. Otherwise, we keep using the exit pipe.
+    if (process->group && process_exit(process->handle, &exited) == 0) {
+      pipe_destroy(process->pipe.exit);
+      process->pipe.exit = exited;
+    }
+
+    // The child process is already running so we can't fail anymore. If the
+    // reaper can't track the child process, it has to be reaped by
+    // `reproc_wait` as usual.
+    int q = reaper_add(process->handle, process->pipe.exit, &process->reaper);
+    (void) q;
   }
 
 finish:
@@ -240,6 +549,7 @@ finish:
   // the stdin/stdout/stderr streams of the child process. Either way, they can
   // be safely closed.
   redirect_destroy(child.in, options.redirect.in.type);
+  handle_destroy(direct);
 
   // See `reproc_poll` for why we do this.
 
@@ -258,15 +568,31 @@ finish:
 
   pipe_destroy(child.exit);
 
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    pipe_destroy((pipe_type) child.extra[i]);
+  }
+
+  handle_destroy(child.ring.memory);
+  handle_destroy(child.ring.doorbell);
+  strv_free(env);
+
   if (r < 0) {
     process->handle = process_destroy(process->handle);
     process->pipe.in = pipe_destroy(process->pipe.in);
     process->pipe.out = pipe_destroy(process->pipe.out);
     process->pipe.err = pipe_destroy(process->pipe.err);
     process->pipe.exit = pipe_destroy(process->pipe.exit);
+    process->cgroup = cgroup_destroy(process->cgroup);
+    process->input.file = handle_destroy(process->input.file);
+    for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+      process->extra[i].pipe = pipe_destroy(process->extra[i].pipe);
+    }
+    process->ring = ring_destroy(process->ring);
     deinit();
   } else if (r == 0) {
     process->handle = PROCESS_INVALID;
+    process->cgroup = cgroup_destroy(process->cgroup);
+    process->input.file = handle_destroy(process->input.file);
     // `process_start` has already taken care of closing the handles for us.
     process->pipe.in = PIPE_INVALID;
     process->pipe.out = PIPE_INVALID;
@@ -282,7 +608,12 @@ finish:
   return r;
 }
 
-enum { PIPES_PER_SOURCE = 4 };
+// stdin, stdout, stderr, the exit pipe, the extra pipes and the doorbell of the
+// ring.
+enum {
+  PIPES_PER_SOURCE = 5 + REPROC_EXTRA_FDS_MAX,
+  RING_SLOT = PIPES_PER_SOURCE - 1
+};
 
 static bool contains_valid_pipe(pipe_event_source *sources, size_t num_sources)
 {
@@ -295,11 +626,13 @@ static bool contains_valid_pipe(pipe_event_source *sources, size_t num_sources)
   return false;
 }
 
-int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
+// Polls once. `*pumped` is set if input was streamed to a child process. This
+// isn't an event so the caller has to poll again if nothing else happened.
+static int poll_once(reproc_event_source *sources,
+                     size_t num_sources,
+                     int timeout,
+                     bool *pumped)
 {
-  ASSERT_EINVAL(sources);
-  ASSERT_EINVAL(num_sources > 0);
-
   size_t earliest = find_earliest_deadline(sources, num_sources);
   int64_t deadline = sources[earliest].process == NULL
                          ? REPROC_INFINITE
@@ -307,6 +640,8 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
 
   int first = expiry(timeout, deadline);
   size_t num_pipes = num_sources * PIPES_PER_SOURCE;
+  // Set if a ring already has records, in which case we don't block.
+  bool ready = false;
   int r = REPROC_ENOMEM;
 
   if (first == REPROC_DEADLINE) {
@@ -336,7 +671,7 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
       continue;
     }
 
-    bool in = interests & REPROC_EVENT_IN;
+    bool in = interests & REPROC_EVENT_IN || input_pending(process);
     pipes[j + 0].pipe = in ? process->pipe.in : PIPE_INVALID;
     pipes[j + 0].interests = PIPE_EVENT_OUT;
 
@@ -352,9 +687,24 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
                 (interests & REPROC_EVENT_OUT &&
                  process->child.out != PIPE_INVALID) ||
                 (interests & REPROC_EVENT_ERR &&
-                 process->child.err != PIPE_INVALID);
+                 process->child.err != PIPE_INVALID) ||
+                (process->group && pipes[j + 1].pipe != PIPE_INVALID) ||
+                (process->group && pipes[j + 2].pipe != PIPE_INVALID);
     pipes[j + 3].pipe = exit ? process->pipe.exit : PIPE_INVALID;
     pipes[j + 3].interests = PIPE_EVENT_IN;
+
+    for (size_t k = 0; k < REPROC_EXTRA_FDS_MAX; k++) {
+      bool extra = interests & (REPROC_EVENT_EXTRA << k);
+      pipes[j + 4 + k].pipe = extra ? process->extra[k].pipe : PIPE_INVALID;
+      pipes[j + 4 + k].interests = process->extra[k].input ? PIPE_EVENT_OUT
+                                                           : PIPE_EVENT_IN;
+    }
+
+    bool ring = interests & REPROC_EVENT_RING && process->ring != NULL;
+    ready = ready || (ring && ring_ready(process->ring));
+    pipes[j + RING_SLOT].pipe = ring ? ring_doorbell(process->ring)
+                                     : PIPE_INVALID;
+    pipes[j + RING_SLOT].interests = PIPE_EVENT_IN;
   }
 
   if (!contains_valid_pipe(pipes, num_pipes)) {
@@ -362,7 +712,7 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
     goto finish;
   }
 
-  r = pipe_poll(pipes, num_pipes, first);
+  r = pipe_poll(pipes, num_pipes, ready ? 0 : first);
   if (r < 0) {
     goto finish;
   }
@@ -371,29 +721,78 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
     sources[i].events = 0;
   }
 
-  if (r == 0 && first != timeout) {
+  if (r == 0 && !ready && first != timeout) {
     // Differentiate between timeout and deadline expiry. Deadline expiry is an
     // event, timeouts are not.
     sources[earliest].events = REPROC_EVENT_DEADLINE;
     r = 1;
-  } else if (r > 0) {
+  } else if (r > 0 || ready) {
     // Convert pipe events to process events.
     for (size_t i = 0; i < num_pipes; i++) {
       if (pipes[i].pipe == PIPE_INVALID) {
         continue;
       }
 
+      reproc_t *process = sources[i / PIPES_PER_SOURCE].process;
+
+      // The stdin pipe doesn't become available to the user until all input
+      // has been written to it.
+      if (i % PIPES_PER_SOURCE == 0 && input_pending(process)) {
+        if (pipes[i].events > 0) {
+          r = input_write(process);
+          if (r < 0) {
+            goto finish;
+          }
+
+          *pumped = true;
+        }
+
+        continue;
+      }
+
+      // The ring is checked separately below.
+      if (i % PIPES_PER_SOURCE == RING_SLOT) {
+        if (pipes[i].events > 0) {
+          r = ring_drain(process->ring);
+          if (r < 0) {
+            goto finish;
+          }
+        }
+
+        continue;
+      }
+
       if (pipes[i].events > 0) {
         // Index in a set of pipes determines the process pipe and thus the
         // process event.
         // 0 = stdin pipe => REPROC_EVENT_IN
         // 1 = stdout pipe => REPROC_EVENT_OUT
         // ...
-        int event = 1 << (i % PIPES_PER_SOURCE);
+        // 4 = first extra pipe => REPROC_EVENT_EXTRA
+        // ...
+        size_t slot = i % PIPES_PER_SOURCE;
+        int event = slot < 4 ? 1 << slot : REPROC_EVENT_EXTRA << (slot - 4);
         sources[i / PIPES_PER_SOURCE].events |= event;
       }
     }
 
+    // Only report the ring once a record is actually available. If the
+    // doorbell rang without one, we have to poll again.
+    for (size_t i = 0; i < num_sources; i++) {
+      reproc_t *process = sources[i].process;
+      size_t j = i * PIPES_PER_SOURCE;
+
+      if (pipes[j + RING_SLOT].pipe == PIPE_INVALID) {
+        continue;
+      }
+
+      if (ring_ready(process->ring)) {
+        sources[i].events |= REPROC_EVENT_RING;
+      } else if (pipes[j + RING_SLOT].events > 0) {
+        *pumped = true;
+      }
+    }
+
     r = 0;
 
     // Count the number of processes with events.
@@ -419,6 +818,24 @@ int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
       }
 
       reproc_t *process = sources[i].process;
+      size_t j = i * PIPES_PER_SOURCE;
+
+      // When the child process runs in its own process group, descendants that
+      // inherited its output streams might keep them open long after the child
+      // process exited. Once the child process has exited, all its output is
+      // already in the pipes so we treat a pipe without pending output as
+      // closed.
+      if (process->group && pipes[j + 1].pipe != PIPE_INVALID &&
+          pipes[j + 1].events == 0) {
+        process->pipe.out = pipe_destroy(process->pipe.out);
+        again = true;
+      }
+
+      if (process->group && pipes[j + 2].pipe != PIPE_INVALID &&
+          pipes[j + 2].events == 0) {
+        process->pipe.err = pipe_destroy(process->pipe.err);
+        again = true;
+      }
 
       if (process->child.out == PIPE_INVALID &&
           process->child.err == PIPE_INVALID) {
@@ -457,6 +874,33 @@ finish:
   return r;
 }
 
+int reproc_poll(reproc_event_source *sources, size_t num_sources, int timeout)
+{
+  ASSERT_EINVAL(sources);
+  ASSERT_EINVAL(num_sources > 0);
+
+  int64_t start = now();
+  int remaining = timeout;
+
+  for (;;) {
+    bool pumped = false;
+
+    int r = poll_once(sources, num_sources, remaining, &pumped);
+    if (r != 0 || !pumped) {
+      return r;
+    }
+
+    if (timeout != REPROC_INFINITE) {
+      int64_t elapsed = now() - start;
+      if (elapsed >= timeout) {
+        return 0;
+      }
+
+      remaining = timeout - (int) elapsed;
+    }
+  }
+}
+
 int reproc_read(reproc_t *process,
                 REPROC_STREAM stream,
                 uint8_t *buffer,
@@ -481,7 +925,7 @@ int reproc_read(reproc_t *process,
   // `reproc_poll` which closes the extra handles we keep open when the child
   // process exits. If we don't, `pipe_read` will block forever because the
   // extra handles we keep open in the parent would never be closed.
-  if (child != PIPE_INVALID) {
+  if (child != PIPE_INVALID || input_pending(process)) {
     int event = stream == REPROC_STREAM_OUT ? REPROC_EVENT_OUT
                                             : REPROC_EVENT_ERR;
     reproc_event_source source = { process, event, 0 };
@@ -511,7 +955,7 @@ int reproc_write(reproc_t *process, const uint8_t *buffer, size_t size)
     return 0;
   }
 
-  if (process->pipe.in == PIPE_INVALID) {
+  if (process->pipe.in == PIPE_INVALID || input_pending(process)) {
     return REPROC_EPIPE;
   }
 
@@ -531,6 +975,13 @@ int reproc_close(reproc_t *process, REPROC_STREAM stream)
 
   switch (stream) {
     case REPROC_STREAM_IN:
+      process->input.data = NULL;
+      process->input.file = handle_destroy(process->input.file);
+      // If stdout shares a socket with stdin, closing our end of stdin doesn't
+      // close the socket so we shut down its sending side instead.
+      if (process->pipe.out != PIPE_INVALID) {
+        (void) pipe_shutdown(process->pipe.in);
+      }
       process->pipe.in = pipe_destroy(process->pipe.in);
       return 0;
     case REPROC_STREAM_OUT:
@@ -544,16 +995,442 @@ int reproc_close(reproc_t *process, REPROC_STREAM stream)
   return REPROC_EINVAL;
 }
 
-int reproc_wait(reproc_t *process, int timeout)
+int reproc_read_extra(reproc_t *process,
+                      size_t index,
+                      uint8_t *buffer,
+                      size_t size)
 {
   ASSERT_EINVAL(process);
   ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
-  ASSERT_EINVAL(process->status != STATUS_NOT_STARTED);
+  ASSERT_EINVAL(index < REPROC_EXTRA_FDS_MAX);
+  ASSERT_EINVAL(buffer);
+
+  pipe_type *pipe = &process->extra[index].pipe;
+
+  if (*pipe == PIPE_INVALID) {
+    return REPROC_EPIPE;
+  }
+
+  ASSERT_EINVAL(!process->extra[index].input);
+
+  int r = pipe_read(*pipe, buffer, size);
+
+  if (r == REPROC_EPIPE) {
+    *pipe = pipe_destroy(*pipe);
+  }
+
+  return r;
+}
+
+int reproc_write_extra(reproc_t *process,
+                       size_t index,
+                       const uint8_t *buffer,
+                       size_t size)
+{
+  ASSERT_EINVAL(process);
+  ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
+  ASSERT_EINVAL(index < REPROC_EXTRA_FDS_MAX);
+
+  pipe_type *pipe = &process->extra[index].pipe;
+
+  if (*pipe == PIPE_INVALID) {
+    return REPROC_EPIPE;
+  }
+
+  ASSERT_EINVAL(process->extra[index].input);
+
+  if (buffer == NULL) {
+    // Allow `NULL` buffers but only if `size == 0`.
+    ASSERT_EINVAL(size == 0);
+    return 0;
+  }
+
+  int r = pipe_write(*pipe, buffer, size);
+
+  if (r == REPROC_EPIPE) {
+    *pipe = pipe_destroy(*pipe);
+  }
+
+  return r;
+}
+
+int reproc_close_extra(reproc_t *process, size_t index)
+{
+  ASSERT_EINVAL(process);
+  ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
+  ASSERT_EINVAL(index < REPROC_EXTRA_FDS_MAX);
+
+  process->extra[index].pipe = pipe_destroy(process->extra[index].pipe);
+
+  return 0;
+}
+
+int reproc_ring_read(reproc_t *process, const uint8_t **data, size_t *size)
+{
+  ASSERT_EINVAL(process);
+  ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
+  ASSERT_EINVAL(process->ring != NULL);
+  ASSERT_EINVAL(data);
+  ASSERT_EINVAL(size);
+
+  for (;;) {
+    int r = ring_read(process->ring, data, size);
+    if (r != REPROC_EWOULDBLOCK || process->nonblocking) {
+      return r;
+    }
+
+    reproc_event_source source = { process, REPROC_EVENT_RING, 0 };
+    r = reproc_poll(&source, 1, REPROC_INFINITE);
+    if (r < 0) {
+      return r;
+    }
+
+    if (source.events & REPROC_EVENT_DEADLINE) {
+      return REPROC_ETIMEDOUT;
+    }
+  }
+}
 
+enum { FANOUT_LIMIT = 65536 };
+
+// Writes to stdin are limited to the amount of bytes that can always be written
+// to a pipe that's writable without blocking.
+enum { FANOUT_WRITE_SIZE = 4096 };
+
+// Duplicates the data in `from` to the stdin pipes of all targets but the last
+// one with `tee` and moves it to the stdin pipe of the last target with
+// `splice`, which consumes it from `from`. Every target has to have received
+// all previous data already. Data is only copied to `buffer` if a target
+// couldn't take all of it, in which case `*filled` is set to the size of the
+// copy and `positions` to how much of it each target received. If `tee` fails
+// for a target other than the first, that target is treated as lagging and
+// `*tee` is set to false so later data is copied instead. Returns the amount
+// of bytes consumed from `from`.
+static int fanout_tee(pipe_type from,
+                      reproc_t **targets,
+                      size_t num_targets,
+                      size_t *positions,
+                      uint8_t *buffer,
+                      size_t limit,
+                      size_t *filled,
+                      bool *tee)
+{
+  size_t first = num_targets;
+  size_t last = num_targets;
   int r = -1;
 
-  if (process->status >= 0) {
-    return process->status;
+  for (size_t i = 0; i < num_targets; i++) {
+    if (targets[i]->pipe.in != PIPE_INVALID) {
+      first = first == num_targets ? i : first;
+      last = i;
+    }
+  }
+
+  if (first == num_targets) {
+    return 0;
+  }
+
+  // With a single target, there's nothing to duplicate.
+  if (first == last) {
+    r = pump_splice(from, targets[last]->pipe.in, limit);
+    if (r == REPROC_EPIPE) {
+      targets[last]->pipe.in = pipe_destroy(targets[last]->pipe.in);
+      r = 0;
+    }
+
+    return r;
+  }
+
+  // Only duplicate as much as every target can take so none of them lags
+  // behind and needs a copy. If we can't tell, `tee` finds out.
+  for (size_t i = 0; i < num_targets; i++) {
+    size_t space = 0;
+
+    if (targets[i]->pipe.in != PIPE_INVALID &&
+        pump_space(targets[i]->pipe.in, &space) == 0) {
+      limit = MIN(limit, space);
+    }
+  }
+
+  if (limit == 0) {
+    return REPROC_EWOULDBLOCK;
+  }
+
+  r = pump_tee(from, targets[first]->pipe.in, limit);
+  if (r <= 0) {
+    return r;
+  }
+
+  size_t size = (size_t) r;
+  bool lagging = false;
+
+  for (size_t i = 0; i < num_targets; i++) {
+    positions[i] = size;
+
+    if (i == first || i == last || targets[i]->pipe.in == PIPE_INVALID) {
+      continue;
+    }
+
+    r = pump_tee(from, targets[i]->pipe.in, size);
+    if (r == REPROC_EPIPE) {
+      targets[i]->pipe.in = pipe_destroy(targets[i]->pipe.in);
+      continue;
+    }
+
+    // The data was already duplicated to the first target so we can't bail
+    // out here. Any other error (e.g. the target's stdin isn't a pipe) is
+    // reported when copying the data to the target later on.
+    if (r < 0 && r != REPROC_EWOULDBLOCK) {
+      *tee = false;
+    }
+
+    positions[i] = r < 0 ? 0 : (size_t) r;
+    lagging = lagging || positions[i] < size;
+  }
+
+  // If another target lagged, it needs a copy of all the data so we might as
+  // well copy it for the last target too.
+  size_t spliced = 0;
+
+  if (!lagging) {
+    r = pump_splice(from, targets[last]->pipe.in, size);
+    if (r == REPROC_EPIPE) {
+      targets[last]->pipe.in = pipe_destroy(targets[last]->pipe.in);
+    } else if (r < 0 && r != REPROC_EWOULDBLOCK) {
+      *tee = false;
+    }
+
+    spliced = r < 0 ? 0 : (size_t) r;
+  }
+
+  // Whatever wasn't spliced is still in `from` so these reads don't block.
+  size_t remaining = size - spliced;
+
+  for (size_t consumed = 0; consumed < remaining;) {
+    r = pipe_read(from, buffer + consumed, remaining - consumed);
+    if (r < 0) {
+      return r;
+    }
+
+    consumed += (size_t) r;
+  }
+
+  if (lagging) {
+    positions[last] = 0;
+    *filled = size;
+  } else if (remaining > 0) {
+    // `buffer` only holds the data the last target didn't get, which every
+    // other target already received.
+    for (size_t i = 0; i < num_targets; i++) {
+      positions[i] = i == last ? 0 : remaining;
+    }
+
+    *filled = remaining;
+  } else {
+    // Every target received all data so nothing had to be copied.
+    memset(positions, 0, num_targets * sizeof(size_t));
+  }
+
+  return (int) size;
+}
+
+int reproc_fanout(reproc_t *source,
+                  REPROC_STREAM stream,
+                  reproc_t **targets,
+                  size_t num_targets,
+                  size_t limit)
+{
+  ASSERT_EINVAL(source);
+  ASSERT_EINVAL(source->status != STATUS_IN_CHILD);
+  ASSERT_EINVAL(stream == REPROC_STREAM_OUT || stream == REPROC_STREAM_ERR);
+  ASSERT_EINVAL(targets);
+  ASSERT_EINVAL(num_targets > 0);
+
+  for (size_t i = 0; i < num_targets; i++) {
+    ASSERT_EINVAL(targets[i]);
+    ASSERT_EINVAL(targets[i] != source);
+    ASSERT_EINVAL(targets[i]->status != STATUS_IN_CHILD);
+    ASSERT_EINVAL(!input_pending(targets[i]));
+  }
+
+  limit = limit == 0 ? FANOUT_LIMIT : limit;
+
+  int event = stream == REPROC_STREAM_OUT ? REPROC_EVENT_OUT : REPROC_EVENT_ERR;
+  pipe_type *from = stream == REPROC_STREAM_OUT ? &source->pipe.out
+                                                : &source->pipe.err;
+
+  // `buffer` holds the data that hasn't been written to every target yet.
+  // `positions` stores how much of `buffer` each target has received.
+  uint8_t *buffer = malloc(limit);
+  size_t *positions = calloc(num_targets, sizeof(size_t));
+  reproc_event_source *sources = calloc(num_targets + 1,
+                                        sizeof(reproc_event_source));
+  size_t filled = 0;
+  bool tee = true;
+  bool retried = false;
+  int r = REPROC_ENOMEM;
+
+  // Block `SIGPIPE` so writing to a target that exited fails with
+  // `REPROC_EPIPE` and the target is skipped from then on.
+  bool blocked = pipe_sigpipe_block();
+
+  if (buffer == NULL || positions == NULL || sources == NULL) {
+    goto finish;
+  }
+
+  for (;;) {
+    size_t min = filled;
+    bool live = false;
+
+    for (size_t i = 0; i < num_targets; i++) {
+      if (targets[i]->pipe.in != PIPE_INVALID) {
+        min = MIN(min, positions[i]);
+        live = true;
+      }
+    }
+
+    if (!live) {
+      r = 0;
+      break;
+    }
+
+    // Drop the data every target has received. The slowest target determines
+    // how fast we read from the source.
+    if (min > 0) {
+      memmove(buffer, buffer + min, filled - min);
+      filled -= min;
+
+      for (size_t i = 0; i < num_targets; i++) {
+        positions[i] = positions[i] > min ? positions[i] - min : 0;
+      }
+    }
+
+    if (*from == PIPE_INVALID && filled == 0) {
+      r = 0;
+      break;
+    }
+
+    // Set if `tee` has to wait for data in `from` or room in the targets.
+    bool waiting = false;
+
+    if (tee && *from != PIPE_INVALID && filled == 0) {
+      r = fanout_tee(*from, targets, num_targets, positions, buffer, limit,
+                     &filled, &tee);
+      if (r > 0) {
+        retried = false;
+        continue;
+      }
+
+      // If `from` is empty or closed, we find out by polling it. On any other
+      // error (including `tee` not being supported), we fall back to copying
+      // the data which reports the error if it wasn't caused by `tee`.
+      tee = tee && (r == 0 || r == REPROC_EWOULDBLOCK);
+      // If `tee` still can't make progress after `from` became readable, we
+      // copy the data once instead of trying again forever.
+      waiting = r == REPROC_EWOULDBLOCK && !retried;
+      retried = false;
+    }
+
+    sources[0] = (reproc_event_source){ source,
+                                        filled < limit ? event : 0, 0 };
+
+    for (size_t i = 0; i < num_targets; i++) {
+      bool pending = positions[i] < filled;
+      sources[i + 1] = (reproc_event_source){ targets[i],
+                                              pending ? REPROC_EVENT_IN : 0,
+                                              0 };
+    }
+
+    // If `tee` has to wait because a target is full, we wait for the full
+    // targets instead of copying the data in `from` so we can keep using `tee`.
+    // The slowest target determines how fast we read from `from` either way.
+    bool full = false;
+
+    for (size_t i = 0; waiting && i < num_targets; i++) {
+      size_t space = 0;
+
+      if (targets[i]->pipe.in != PIPE_INVALID &&
+          pump_space(targets[i]->pipe.in, &space) == 0 && space == 0) {
+        sources[i + 1].interests = REPROC_EVENT_IN;
+        full = true;
+      }
+    }
+
+    if (full) {
+      sources[0].interests = 0;
+    }
+
+    r = reproc_poll(sources, num_targets + 1, REPROC_INFINITE);
+    if (r < 0) {
+      break;
+    }
+
+    for (size_t i = 0; i < num_targets + 1; i++) {
+      if (sources[i].events & REPROC_EVENT_DEADLINE) {
+        r = REPROC_ETIMEDOUT;
+        goto finish;
+      }
+    }
+
+    if (full) {
+      continue;
+    }
+
+    if (sources[0].events & event) {
+      // `from` has data now so try `tee` again instead of copying the data.
+      if (waiting) {
+        retried = true;
+        continue;
+      }
+
+      r = reproc_read(source, stream, buffer + filled, limit - filled);
+      if (r < 0 && r != REPROC_EPIPE && r != REPROC_EWOULDBLOCK) {
+        break;
+      }
+
+      filled += r > 0 ? (size_t) r : 0;
+    }
+
+    for (size_t i = 0; i < num_targets; i++) {
+      if (!(sources[i + 1].events & REPROC_EVENT_IN)) {
+        continue;
+      }
+
+      size_t size = MIN(filled - positions[i], FANOUT_WRITE_SIZE);
+
+      r = reproc_write(targets[i], buffer + positions[i], size);
+      if (r < 0 && r != REPROC_EPIPE && r != REPROC_EWOULDBLOCK) {
+        goto finish;
+      }
+
+      positions[i] += r > 0 ? (size_t) r : 0;
+    }
+  }
+
+  if (r == 0) {
+    for (size_t i = 0; i < num_targets; i++) {
+      targets[i]->pipe.in = pipe_destroy(targets[i]->pipe.in);
+    }
+  }
+
+finish:
+  pipe_sigpipe_unblock(blocked);
+  free(buffer);
+  free(positions);
+  free(sources);
+
+  return r;
+}
+
+// Waits until the exit pipe becomes readable while streaming input to the
+// child process. Unlike `reproc_wait`, the child process isn't reaped so its
+// process ID (and process group ID) can't be reused yet.
+static int wait_exit(reproc_t *process, int timeout)
+{
+  // If the reaper already reaped the child process, we only have to pick up
+  // its exit status.
+  if (process->status >= 0 || reaper_reaped(process->reaper)) {
+    return 0;
   }
 
   if (timeout == REPROC_DEADLINE) {
@@ -567,19 +1444,73 @@ int reproc_wait(reproc_t *process, int timeout)
 
   ASSERT(process->pipe.exit != PIPE_INVALID);
 
-  pipe_event_source source = { .pipe = process->pipe.exit,
-                               .interests = PIPE_EVENT_IN };
+  int64_t start = now();
+  int remaining = timeout;
+  int r = -1;
 
-  r = pipe_poll(&source, 1, timeout);
-  if (r <= 0) {
-    return r == 0 ? REPROC_ETIMEDOUT : r;
+  for (;;) {
+    pipe_event_source sources[] = {
+      { .pipe = process->pipe.exit, .interests = PIPE_EVENT_IN },
+      { .pipe = process->pipe.in, .interests = PIPE_EVENT_OUT },
+    };
+    size_t num_sources = input_pending(process) ? 2 : 1;
+
+    r = pipe_poll(sources, num_sources, remaining);
+    if (r <= 0) {
+      return r == 0 ? REPROC_ETIMEDOUT : r;
+    }
+
+    if (sources[0].events > 0) {
+      return 0;
+    }
+
+    r = input_write(process);
+    if (r < 0) {
+      return r;
+    }
+
+    if (timeout != REPROC_INFINITE) {
+      int64_t elapsed = now() - start;
+      if (elapsed >= timeout) {
+        return REPROC_ETIMEDOUT;
+      }
+
+      remaining = timeout - (int) elapsed;
+    }
   }
+}
 
-  r = process_wait(process->handle);
+int reproc_wait(reproc_t *process, int timeout)
+{
+  ASSERT_EINVAL(process);
+  ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
+  ASSERT_EINVAL(process->status != STATUS_NOT_STARTED);
+
+  int r = -1;
+
+  if (process->status >= 0) {
+    return process->status;
+  }
+
+  r = wait_exit(process, timeout);
+  if (r < 0) {
+    return r;
+  }
+
+  r = reaper_wait(process->handle, process->reaper, &process->usage);
   if (r < 0) {
     return r;
   }
 
+  process->reaper = NULL;
+
+  if (process->cgroup != CGROUP_INVALID) {
+    // The child process has already been cleaned up at this point so we
+    // can't fail anymore. The cgroup statistics are best effort.
+    int q = cgroup_stats(process->cgroup, &process->usage);
+    (void) q;
+  }
+
   process->pipe.exit = pipe_destroy(process->pipe.exit);
 
   return process->status = r;
@@ -591,11 +1522,15 @@ int reproc_terminate(reproc_t *process)
   ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
   ASSERT_EINVAL(process->status != STATUS_NOT_STARTED);
 
+  // Once the child process has been reaped, its process ID (and therefore its
+  // process group ID once the group is empty) might be reused by an unrelated
+  // process so we can't signal either anymore.
   if (process->status >= 0) {
     return 0;
   }
 
-  return process_terminate(process->handle);
+  return reaper_signal(process->handle, process->reaper, process->group,
+                       process_terminate);
 }
 
 int reproc_kill(reproc_t *process)
@@ -604,11 +1539,31 @@ int reproc_kill(reproc_t *process)
   ASSERT_EINVAL(process->status != STATUS_IN_CHILD);
   ASSERT_EINVAL(process->status != STATUS_NOT_STARTED);
 
+  // See `reproc_terminate`.
   if (process->status >= 0) {
     return 0;
   }
 
-  return process_kill(process->handle);
+  return reaper_signal(process->handle, process->reaper, process->group,
+                       process_kill);
+}
+
+static int stop_signal(reproc_t *process, REPROC_STOP action)
+{
+  switch (action) {
+    case REPROC_STOP_NOOP:
+    case REPROC_STOP_WAIT:
+      return 0;
+    case REPROC_STOP_TERMINATE:
+      return reproc_terminate(process);
+    case REPROC_STOP_KILL:
+      return reproc_kill(process);
+    case REPROC_STOP_KILL_CGROUP:
+      return process->cgroup != CGROUP_INVALID ? cgroup_kill(process->cgroup)
+                                                : reproc_kill(process);
+  }
+
+  return REPROC_EINVAL;
 }
 
 int reproc_stop(reproc_t *process, reproc_stop_actions stop)
@@ -620,38 +1575,58 @@ int reproc_stop(reproc_t *process, reproc_stop_actions stop)
   stop = parse_stop_actions(stop);
 
   reproc_stop_action actions[] = { stop.first, stop.second, stop.third };
-  int r = -1;
+  size_t i = 0;
+  int r = 0;
 
-  for (size_t i = 0; i < ARRAY_SIZE(actions); i++) {
-    r = REPROC_EINVAL; // NOLINT
-
-    switch (actions[i].action) {
-      case REPROC_STOP_NOOP:
-        r = 0;
-        continue;
-      case REPROC_STOP_WAIT:
-        r = 0;
-        break;
-      case REPROC_STOP_TERMINATE:
-        r = reproc_terminate(process);
-        break;
-      case REPROC_STOP_KILL:
-        r = reproc_kill(process);
-        break;
+  for (; i < ARRAY_SIZE(actions); i++) {
+    if (actions[i].action == REPROC_STOP_NOOP) {
+      continue;
     }
 
+    r = stop_signal(process, actions[i].action);
     // Stop if `reproc_terminate` or `reproc_kill` fail.
     if (r < 0) {
-      break;
+      return r;
     }
 
-    r = reproc_wait(process, actions[i].timeout);
+    r = wait_exit(process, actions[i].timeout);
     if (r != REPROC_ETIMEDOUT) {
       break;
     }
   }
 
-  return r;
+  if (r < 0 || i == ARRAY_SIZE(actions)) {
+    return r;
+  }
+
+  // The child process exited but, unless it was reaped before, its process
+  // group ID can't have been reused yet. Descendants in its process group or
+  // cgroup might still be running so we apply the remaining stop actions to
+  // them before reaping the child process. There's no way to wait for the
+  // descendants to exit so the remaining actions are applied right away.
+  // `cgroup.kill` doesn't refer to the child process by ID so we write it even
+  // if the child process was already reaped.
+  if (process->group || process->cgroup != CGROUP_INVALID) {
+    for (i++; i < ARRAY_SIZE(actions); i++) {
+      r = stop_signal(process, actions[i].action);
+      if (r < 0) {
+        return r;
+      }
+    }
+  }
+
+  return reproc_wait(process, REPROC_INFINITE);
+}
+
+int reproc_rusage(reproc_t *process, reproc_usage *usage)
+{
+  ASSERT_EINVAL(process);
+  ASSERT_EINVAL(usage);
+  ASSERT_EINVAL(process->status >= 0);
+
+  *usage = process->usage;
+
+  return 0;
 }
 
 int reproc_pid(reproc_t *process)
@@ -667,11 +1642,20 @@ reproc_t *reproc_destroy(reproc_t *process)
 {
   ASSERT_RETURN(process, NULL);
 
-  if (process->status == STATUS_IN_PROGRESS) {
+  // Even if the child process was already reaped, its descendants might still
+  // be running in its cgroup.
+  if (process->status == STATUS_IN_PROGRESS ||
+      (process->status >= 0 && process->cgroup != CGROUP_INVALID)) {
     reproc_stop(process, process->stop);
   }
 
+  // If the child process is still running, the reaper (if enabled) reaps it
+  // once it exits.
+  reaper_orphan(process->reaper);
+
   process_destroy(process->handle);
+  cgroup_destroy(process->cgroup);
+  handle_destroy(process->input.file);
   pipe_destroy(process->pipe.in);
   pipe_destroy(process->pipe.out);
   pipe_destroy(process->pipe.err);
@@ -680,6 +1664,12 @@ reproc_t *reproc_destroy(reproc_t *process)
   pipe_destroy(process->child.out);
   pipe_destroy(process->child.err);
 
+  for (size_t i = 0; i < REPROC_EXTRA_FDS_MAX; i++) {
+    pipe_destroy(process->extra[i].pipe);
+  }
+
+  ring_destroy(process->ring);
+
   if (process->status != STATUS_NOT_STARTED) {
     deinit();
   }
@@ -689,6 +1679,45 @@ reproc_t *reproc_destroy(reproc_t *process)
   return NULL;
 }
 
+reproc_cache_stats reproc_path_cache_stats(void)
+{
+  return path_cache_stats();
+}
+
+int reproc_reaper_start(bool thread)
+{
+  return reaper_start(thread);
+}
+
+int reproc_reaper_stop(void)
+{
+  return reaper_stop();
+}
+
+int reproc_reap(int timeout)
+{
+  ASSERT_EINVAL(timeout >= 0 || timeout == REPROC_INFINITE);
+
+  return reaper_reap(timeout);
+}
+
+int reproc_memfd(const uint8_t *data, size_t size, reproc_handle *handle)
+{
+  ASSERT_EINVAL(data || size == 0);
+  ASSERT_EINVAL(handle);
+
+  handle_type file = HANDLE_INVALID;
+
+  int r = memfd_from(data, size, &file);
+  if (r < 0) {
+    return r;
+  }
+
+  *handle = (reproc_handle) file;
+
+  return 0;
+}
+
 const char *reproc_strerror(int error)
 {
   return error_string(error);
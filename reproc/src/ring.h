@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "handle.h"
+#include "pipe.h"
+
+// The parent process end of a shared-memory ring. See reproc/ring.h.
+
+typedef struct reproc_ring *ring_type;
+
+// Creates a ring with room for at least `size` bytes of records. `memory` and
+// `doorbell` are set to the handles the child process opens the ring with. They
+// have to be closed once the child process has started.
+//
+// POSIX only.
+int ring_init(size_t size,
+              ring_type *ring,
+              handle_type *memory,
+              handle_type *doorbell);
+
+// Returns the socket that becomes readable once the child process writes a
+// record after `ring_ready` returned false or closes its end of the ring.
+pipe_type ring_doorbell(ring_type ring);
+
+// Returns true if a record can be read or the child process closed its end of
+// the ring. Otherwise, asks the child process to ring the doorbell once it
+// writes the next record.
+bool ring_ready(ring_type ring);
+
+// Consumes the pending notifications of the doorbell.
+int ring_drain(ring_type ring);
+
+// Releases the record returned by the previous call and returns the next one.
+// Returns `REPROC_EWOULDBLOCK` if the ring is empty and `REPROC_EPIPE` if the
+// child process closed its end of the ring as well.
+int ring_read(ring_type ring, const uint8_t **data, size_t *size);
+
+ring_type ring_destroy(ring_type ring);
@@ -0,0 +1,504 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring.h"
+
+#include <reproc/ring.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "memfd.h"
+
+// The ring consists of a header followed by the records. Positions only ever
+// increase and are reduced modulo the size of the ring to get an offset. Every
+// record starts with an 8-byte header that holds its size and is padded to a
+// multiple of 8 bytes. If a record doesn't fit before the end of the ring, the
+// writer skips to the start with a padding record.
+
+// `value` is only written by one side. `waiting` is set by the other side when
+// it waits for `value` to change and cleared by the side that changes `value`.
+struct ring_line {
+  uint64_t value;
+  uint32_t waiting;
+  uint8_t padding[52];
+};
+
+struct ring_header {
+  // Written by the child process. The parent process waits for records.
+  struct ring_line head;
+  // Written by the parent process. The child process waits for space.
+  struct ring_line tail;
+  uint64_t size;
+};
+
+enum { RING_DATA = 256, RING_MIN = 4096, RECORD = 8 };
+
+static const uint32_t RING_PADDING = UINT32_MAX;
+
+struct reproc_ring {
+  struct ring_header *header;
+  uint8_t *data;
+  uint64_t size;
+  int doorbell;
+  // Our own copy of `head` (writer) or `tail` (reader).
+  uint64_t position;
+  // Size of the record that was reserved (writer) or handed out (reader) but
+  // not yet committed or released.
+  uint64_t held;
+  bool closed;
+};
+
+static uint64_t record_size(uint64_t size)
+{
+  return RECORD + ((size + 7) & ~(uint64_t) 7);
+}
+
+static int ring_map(int memory, uint64_t size, struct reproc_ring *ring)
+{
+  void *mapping = mmap(NULL, RING_DATA + size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, memory, 0);
+  if (mapping == MAP_FAILED) {
+    return -errno;
+  }
+
+  ring->header = mapping;
+  ring->data = (uint8_t *) mapping + RING_DATA;
+  ring->size = size;
+
+  return 0;
+}
+
+static void ring_unmap(struct reproc_ring *ring)
+{
+  if (ring->header != NULL) {
+    munmap(ring->header, RING_DATA + ring->size);
+  }
+}
+
+// Wakes up the other side if it's waiting on `line`. Called after changing
+// `line->value`.
+static void ring_notify(struct reproc_ring *ring, struct ring_line *line)
+{
+  const uint8_t byte = 0;
+
+  // Pairs with the fence in `ring_wait` so either we see `waiting` or the other
+  // side sees the new value.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&line->waiting, __ATOMIC_RELAXED) &&
+      __atomic_exchange_n(&line->waiting, 0, __ATOMIC_SEQ_CST)) {
+    // If the socket is full, a notification is already pending.
+    (void) !write(ring->doorbell, &byte, sizeof(byte));
+  }
+}
+
+// Announces that we're waiting for `line->value` to change from `value`.
+// Returns false if it changed in the meantime.
+static bool ring_wait(struct ring_line *line, uint64_t value)
+{
+  __atomic_store_n(&line->waiting, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  return __atomic_load_n(&line->value, __ATOMIC_ACQUIRE) == value;
+}
+
+int ring_drain(struct reproc_ring *ring)
+{
+  uint8_t buffer[64];
+
+  for (;;) {
+    ssize_t r = read(ring->doorbell, buffer, sizeof(buffer));
+    if (r == 0) {
+      ring->closed = true;
+      return 0;
+    }
+
+    if (r < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -errno;
+    }
+  }
+}
+
+static int ring_socketpair(int *parent, int *child)
+{
+  int pair[] = { HANDLE_INVALID, HANDLE_INVALID };
+  int r = -1;
+
+  r = socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+  if (r < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = handle_cloexec(pair[0], true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = handle_cloexec(pair[1], true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = pipe_nonblocking(pair[0], true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  *parent = pair[0];
+  *child = pair[1];
+
+finish:
+  if (r < 0) {
+    handle_destroy(pair[0]);
+    handle_destroy(pair[1]);
+  }
+
+  return r;
+}
+
+int ring_init(size_t size,
+              struct reproc_ring **ring,
+              int *memory,
+              int *doorbell)
+{
+  ASSERT(ring);
+  ASSERT(memory);
+  ASSERT(doorbell);
+
+  struct reproc_ring *result = NULL;
+  int file = HANDLE_INVALID;
+  int child = HANDLE_INVALID;
+  uint64_t capacity = RING_MIN;
+  int r = -1;
+
+  while (capacity < size) {
+    if (capacity > (uint64_t) SSIZE_MAX / 4) {
+      return REPROC_ENOMEM;
+    }
+
+    capacity *= 2;
+  }
+
+  result = calloc(1, sizeof(struct reproc_ring));
+  if (result == NULL) {
+    r = -errno;
+    goto finish;
+  }
+
+  result->doorbell = HANDLE_INVALID;
+
+  r = memfd_open(&file);
+  if (r < 0) {
+    goto finish;
+  }
+
+  if (ftruncate(file, (off_t) (RING_DATA + capacity)) < 0) {
+    r = -errno;
+    goto finish;
+  }
+
+  r = ring_map(file, capacity, result);
+  if (r < 0) {
+    goto finish;
+  }
+
+  result->header->size = capacity;
+
+  r = ring_socketpair(&result->doorbell, &child);
+  if (r < 0) {
+    goto finish;
+  }
+
+  *ring = result;
+  *memory = file;
+  *doorbell = child;
+
+finish:
+  if (r < 0) {
+    handle_destroy(child);
+    handle_destroy(file);
+    ring_destroy(result);
+  }
+
+  return r;
+}
+
+int ring_doorbell(struct reproc_ring *ring)
+{
+  ASSERT(ring);
+  return ring->doorbell;
+}
+
+bool ring_ready(struct reproc_ring *ring)
+{
+  ASSERT(ring);
+
+  struct ring_line *head = &ring->header->head;
+
+  if (ring->closed ||
+      __atomic_load_n(&head->value, __ATOMIC_ACQUIRE) != ring->position) {
+    return true;
+  }
+
+  return !ring_wait(head, ring->position);
+}
+
+int ring_read(struct reproc_ring *ring, const uint8_t **data, size_t *size)
+{
+  ASSERT(ring);
+  ASSERT(data);
+  ASSERT(size);
+
+  if (ring->held > 0) {
+    ring->position += ring->held;
+    ring->held = 0;
+    __atomic_store_n(&ring->header->tail.value, ring->position,
+                     __ATOMIC_RELEASE);
+    ring_notify(ring, &ring->header->tail);
+  }
+
+  for (;;) {
+    uint64_t head = __atomic_load_n(&ring->header->head.value,
+                                    __ATOMIC_ACQUIRE);
+    if (head == ring->position) {
+      return ring->closed ? -EPIPE : -EWOULDBLOCK;
+    }
+
+    uint64_t offset = ring->position & (ring->size - 1);
+    uint32_t length = 0;
+
+    if (head - ring->position > ring->size) {
+      return -EIO;
+    }
+
+    memcpy(&length, ring->data + offset, sizeof(length));
+
+    if (length == RING_PADDING) {
+      ring->position += ring->size - offset;
+      __atomic_store_n(&ring->header->tail.value, ring->position,
+                       __ATOMIC_RELEASE);
+      ring_notify(ring, &ring->header->tail);
+      continue;
+    }
+
+    // Don't trust the child process to stay within the bounds of the ring.
+    if (offset + record_size(length) > ring->size) {
+      return -EIO;
+    }
+
+    *data = ring->data + offset + RECORD;
+    *size = length;
+    ring->held = record_size(length);
+
+    return 0;
+  }
+}
+
+struct reproc_ring *ring_destroy(struct reproc_ring *ring)
+{
+  if (ring == NULL) {
+    return NULL;
+  }
+
+  ring_unmap(ring);
+  handle_destroy(ring->doorbell);
+  free(ring);
+
+  return NULL;
+}
+
+static int parse_fd(const char **string, int *fd)
+{
+  char *end = NULL;
+
+  errno = 0;
+  long value = strtol(*string, &end, 10);
+  if (errno != 0 || end == *string || value < 0 || value > INT_MAX) {
+    return REPROC_EINVAL;
+  }
+
+  *string = end;
+  *fd = (int) value;
+
+  return 0;
+}
+
+int reproc_ring_open(reproc_ring **ring)
+{
+  ASSERT_EINVAL(ring);
+
+  const char *value = getenv("REPROC_RING");
+  struct reproc_ring *result = NULL;
+  int memory = HANDLE_INVALID;
+  int doorbell = HANDLE_INVALID;
+  struct stat info;
+  int r = -1;
+
+  ASSERT_EINVAL(value != NULL);
+
+  r = parse_fd(&value, &memory);
+  if (r < 0) {
+    return r;
+  }
+
+  ASSERT_EINVAL(*value++ == ',');
+
+  r = parse_fd(&value, &doorbell);
+  if (r < 0) {
+    return r;
+  }
+
+  ASSERT_EINVAL(*value == '\0');
+
+  if (fstat(memory, &info) < 0) {
+    return -errno;
+  }
+
+  ASSERT_EINVAL(info.st_size > RING_DATA);
+
+  uint64_t size = (uint64_t) info.st_size - RING_DATA;
+  ASSERT_EINVAL(size >= RING_MIN && (size & (size - 1)) == 0);
+
+  result = calloc(1, sizeof(struct reproc_ring));
+  if (result == NULL) {
+    return -errno;
+  }
+
+  r = ring_map(memory, size, result);
+  if (r < 0) {
+    goto finish;
+  }
+
+  // The mapping keeps the memory alive.
+  handle_destroy(memory);
+
+  // Our end of the ring isn't meant to be inherited any further.
+  r = handle_cloexec(doorbell, true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  r = pipe_nonblocking(doorbell, true);
+  if (r < 0) {
+    goto finish;
+  }
+
+  result->doorbell = doorbell;
+  result->position = __atomic_load_n(&result->header->head.value,
+                                     __ATOMIC_ACQUIRE);
+  *ring = result;
+
+finish:
+  if (r < 0) {
+    ring_unmap(result);
+    free(result);
+  }
+
+  return r;
+}
+
+int reproc_ring_reserve(reproc_ring *ring, size_t size, uint8_t **buffer)
+{
+  ASSERT_EINVAL(ring);
+  ASSERT_EINVAL(buffer);
+  ASSERT_EINVAL(ring->held == 0);
+  ASSERT_EINVAL(size <= ring->size / 2 - RECORD);
+
+  struct ring_line *tail = &ring->header->tail;
+  uint64_t needed = record_size(size);
+  uint64_t offset = ring->position & (ring->size - 1);
+  // Records never wrap around so skip to the start if it doesn't fit.
+  uint64_t padding = ring->size - offset < needed ? ring->size - offset : 0;
+
+  for (;;) {
+    uint64_t value = __atomic_load_n(&tail->value, __ATOMIC_ACQUIRE);
+
+    if (ring->position + padding + needed - value <= ring->size) {
+      break;
+    }
+
+    if (!ring_wait(tail, value)) {
+      continue;
+    }
+
+    struct pollfd pollfd = { .fd = ring->doorbell, .events = POLLIN };
+
+    int r = poll(&pollfd, 1, -1);
+    if (r < 0 && errno != EINTR) {
+      return -errno;
+    }
+
+    r = ring_drain(ring);
+    if (r < 0) {
+      return r;
+    }
+
+    if (ring->closed) {
+      return REPROC_EPIPE;
+    }
+  }
+
+  if (padding > 0) {
+    memcpy(ring->data + offset, &RING_PADDING, sizeof(RING_PADDING));
+    ring->position += padding;
+    offset = 0;
+  }
+
+  *buffer = ring->data + offset + RECORD;
+  ring->held = needed;
+
+  return 0;
+}
+
+int reproc_ring_commit(reproc_ring *ring, size_t size)
+{
+  ASSERT_EINVAL(ring);
+  ASSERT_EINVAL(ring->held > 0 && record_size(size) <= ring->held);
+
+  uint32_t length = (uint32_t) size;
+  uint64_t offset = ring->position & (ring->size - 1);
+
+  memcpy(ring->data + offset, &length, sizeof(length));
+
+  ring->position += record_size(size);
+  ring->held = 0;
+
+  __atomic_store_n(&ring->header->head.value, ring->position,
+                   __ATOMIC_RELEASE);
+  ring_notify(ring, &ring->header->head);
+
+  return 0;
+}
+
+int reproc_ring_write(reproc_ring *ring, const uint8_t *data, size_t size)
+{
+  ASSERT_EINVAL(data || size == 0);
+
+  uint8_t *buffer = NULL;
+
+  int r = reproc_ring_reserve(ring, size, &buffer);
+  if (r < 0) {
+    return r;
+  }
+
+  if (size > 0) {
+    memcpy(buffer, data, size);
+  }
+
+  return reproc_ring_commit(ring, size);
+}
+
+reproc_ring *reproc_ring_close(reproc_ring *ring)
+{
+  return ring_destroy(ring);
+}
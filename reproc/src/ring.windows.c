@@ -0,0 +1,84 @@
+#include "ring.h"
+
+#include <reproc/ring.h>
+
+#include <windows.h>
+
+int ring_init(size_t size,
+              struct reproc_ring **ring,
+              HANDLE *memory,
+              HANDLE *doorbell)
+{
+  (void) size;
+  (void) ring;
+  (void) memory;
+  (void) doorbell;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+SOCKET ring_doorbell(struct reproc_ring *ring)
+{
+  (void) ring;
+  return PIPE_INVALID;
+}
+
+bool ring_ready(struct reproc_ring *ring)
+{
+  (void) ring;
+  return false;
+}
+
+int ring_drain(struct reproc_ring *ring)
+{
+  (void) ring;
+  return 0;
+}
+
+int ring_read(struct reproc_ring *ring, const uint8_t **data, size_t *size)
+{
+  (void) ring;
+  (void) data;
+  (void) size;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+struct reproc_ring *ring_destroy(struct reproc_ring *ring)
+{
+  (void) ring;
+  return NULL;
+}
+
+int reproc_ring_open(reproc_ring **ring)
+{
+  (void) ring;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int reproc_ring_reserve(reproc_ring *ring, size_t size, uint8_t **buffer)
+{
+  (void) ring;
+  (void) size;
+  (void) buffer;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int reproc_ring_commit(reproc_ring *ring, size_t size)
+{
+  (void) ring;
+  (void) size;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+int reproc_ring_write(reproc_ring *ring, const uint8_t *data, size_t size)
+{
+  (void) ring;
+  (void) data;
+  (void) size;
+  return -ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+reproc_ring *reproc_ring_close(reproc_ring *ring)
+{
+  (void) ring;
+  return NULL;
+}
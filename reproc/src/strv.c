@@ -6,83 +6,56 @@
 
 #include "error.h"
 
-static char *str_dup(const char *s)
-{
-  ASSERT_RETURN(s, NULL);
-
-  char *r = malloc(strlen(s) + 1);
-  if (!r) {
-    return NULL;
-  }
-
-  strcpy(r, s); // NOLINT
-
-  return r;
-}
-
 char **strv_concat(char *const *a, const char *const *b)
 {
   char *const *i = NULL;
   const char *const *j = NULL;
   size_t size = 1;
+  size_t bytes = 0;
   size_t c = 0;
 
   STRV_FOREACH(i, a) {
     size++;
+    bytes += strlen(*i) + 1;
   }
 
   STRV_FOREACH(j, b) {
     size++;
+    bytes += strlen(*j) + 1;
   }
 
-  char **r = calloc(size, sizeof(char *));
+  // The strings are stored right after the pointer array.
+  char **r = malloc(size * sizeof(char *) + bytes);
   if (!r) {
-    goto finish;
+    return NULL;
   }
 
-  STRV_FOREACH(i, a) {
-    r[c] = str_dup(*i);
-    if (!r[c]) {
-      goto finish;
-    }
+  char *string = (char *) (r + size);
 
-    c++;
+  STRV_FOREACH(i, a) {
+    size_t length = strlen(*i) + 1;
+    memcpy(string, *i, length);
+    r[c++] = string;
+    string += length;
   }
 
   STRV_FOREACH(j, b) {
-    r[c] = str_dup(*j);
-    if (!r[c]) {
-      goto finish;
-    }
-
-    c++;
+    size_t length = strlen(*j) + 1;
+    memcpy(string, *j, length);
+    r[c++] = string;
+    string += length;
   }
 
   r[c++] = NULL;
 
-finish:
-  if (c < size) {
-    STRV_FOREACH(i, r) {
-      free(*i);
-    }
-
-    free(r);
-
-    return NULL;
-  }
+  ASSERT(c == size);
+  ASSERT(string == (char *) (r + size) + bytes);
 
   return r;
 }
 
 char **strv_free(char **l)
 {
-  char **s = NULL;
-
-  STRV_FOREACH(s, l) {
-    free(*s);
-  }
-
   free(l);
-
   return NULL;
 }
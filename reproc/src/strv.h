@@ -2,6 +2,9 @@
 
 #define STRV_FOREACH(s, l) for ((s) = (l); (s) && *(s); (s)++)
 
+// Concatenates the NULL-terminated string arrays `a` and `b`. The pointer array
+// and the strings it points to are stored in a single allocation so the result
+// can be released with a single call to `free` (or `strv_free`).
 char **strv_concat(char *const *a, const char *const *b);
 
 char **strv_free(char **l);
@@ -0,0 +1,45 @@
+#include <reproc/run.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "assert.h"
+
+// Big enough to make the capture grow a few times.
+enum { SIZE = 1 << 20 };
+
+int main(void)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/capture", NULL };
+  uint8_t *data = malloc(SIZE);
+  const uint8_t *view = NULL;
+  size_t size = 0;
+  int r = -1;
+
+  ASSERT(data);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    data[i] = (uint8_t) ('a' + i % 26);
+  }
+
+  reproc_capture *capture = reproc_capture_new();
+  ASSERT(capture);
+
+  reproc_options options = { .input = { data, SIZE } };
+  r = reproc_run_ex(argv, options, reproc_sink_capture(capture),
+                    REPROC_SINK_NULL);
+  ASSERT_EQ_INT(r, 0);
+
+  r = reproc_capture_view(capture, &view, &size);
+  ASSERT_OK(r);
+  ASSERT_EQ_SIZE(size, (size_t) SIZE);
+  ASSERT_EQ_MEM(view, data, size);
+
+  // The capture can't grow anymore once it's been viewed.
+  reproc_sink sink = reproc_sink_capture(capture);
+  r = sink.function(REPROC_STREAM_OUT, data, 1, sink.context);
+  ASSERT(r == REPROC_EINVAL);
+
+  reproc_capture_destroy(capture);
+  free(data);
+}
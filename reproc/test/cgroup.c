@@ -0,0 +1,162 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+// Finds the cgroup v2 directory of this process and creates a child cgroup in
+// it. Returns false if there's no cgroup v2 hierarchy we're allowed to write
+// to.
+static bool cgroup_create(char *path, size_t size)
+{
+  char mount[256] = { 0 };
+  char own[256] = { 0 };
+  char line[512];
+
+  FILE *mounts = fopen("/proc/self/mounts", "r");
+  if (mounts == NULL) {
+    return false;
+  }
+
+  while (fgets(line, sizeof(line), mounts) != NULL) {
+    char type[32];
+    if (sscanf(line, "%*s %255s %31s", mount, type) == 2 &&
+        strcmp(type, "cgroup2") == 0) {
+      break;
+    }
+
+    mount[0] = '\0';
+  }
+
+  fclose(mounts);
+
+  FILE *cgroup = fopen("/proc/self/cgroup", "r");
+  if (cgroup == NULL) {
+    return false;
+  }
+
+  while (fgets(line, sizeof(line), cgroup) != NULL) {
+    if (sscanf(line, "0::%255s", own) == 1) {
+      break;
+    }
+  }
+
+  fclose(cgroup);
+
+  if (mount[0] == '\0' || own[0] == '\0') {
+    return false;
+  }
+
+  snprintf(path, size, "%s%s/reproc-test-%d", mount,
+           strcmp(own, "/") == 0 ? "" : own, (int) getpid());
+
+  return mkdir(path, 0755) == 0;
+}
+
+// The killed descendants are reparented and only leave the cgroup once they
+// exit so retry until the cgroup is empty.
+static void cgroup_remove(const char *path)
+{
+  struct timespec delay = { .tv_nsec = 10 * 1000 * 1000 };
+  int r = -1;
+
+  for (int i = 0; i < 500; i++) {
+    r = rmdir(path);
+    if (r == 0 || errno != EBUSY) {
+      break;
+    }
+
+    nanosleep(&delay, NULL);
+  }
+
+  ASSERT_MSG(r == 0, "%s", strerror(errno));
+}
+
+static void run(const char *path, bool destroy)
+{
+  // The shell exits right away but leaves `sleep` running in the cgroup.
+  const char *argv[] = { "sh", "-c", "sleep 10 & echo started", NULL };
+  reproc_options options = { 0 };
+  options.cgroup.path = path;
+  // Track the exit of the shell independently of `sleep` (see the
+  // `process_group` option).
+  options.process_group = true;
+  options.stop = (reproc_stop_actions){
+    { REPROC_STOP_WAIT, REPROC_INFINITE },
+    { REPROC_STOP_KILL_CGROUP, REPROC_INFINITE },
+    { REPROC_STOP_NOOP, 0 },
+  };
+
+  char *output = NULL;
+  reproc_sink sink = reproc_sink_string(&output);
+  int r = -1;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  r = reproc_drain(process, sink, REPROC_SINK_NULL);
+  ASSERT_OK(r);
+  ASSERT(output != NULL);
+
+  ASSERT_EQ_STR(output, "started\n");
+
+  if (destroy) {
+    // The shell is reaped before `reproc_destroy` runs the stop actions.
+    r = reproc_wait(process, REPROC_INFINITE);
+  } else {
+    // The shell exits during `REPROC_STOP_WAIT`.
+    r = reproc_stop(process, options.stop);
+  }
+
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(output);
+
+  cgroup_remove(path);
+}
+
+int main(void)
+{
+  char path[1024];
+
+  // Skip if we can't create a delegated cgroup.
+  if (!cgroup_create(path, sizeof(path))) {
+    return 0;
+  }
+
+  // Skip if we can't move processes into the cgroup (e.g. because of the
+  // "no internal processes" rule).
+  const char *argv[] = { "true", NULL };
+  reproc_options options = { 0 };
+  options.cgroup.path = path;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  int r = reproc_start(process, argv, options);
+  reproc_destroy(process);
+
+  if (r < 0) {
+    rmdir(path);
+    return 0;
+  }
+
+  run(path, false);
+
+  ASSERT(mkdir(path, 0755) == 0);
+  run(path, true);
+}
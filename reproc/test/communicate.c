@@ -0,0 +1,97 @@
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "assert.h"
+
+// Much bigger than the pipe buffers so writing stdin and reading stdout and
+// stderr have to be interleaved.
+enum { SIZE = 1 << 20 };
+
+struct input {
+  const char *data;
+  size_t offset;
+};
+
+static int source(uint8_t *buffer, size_t size, size_t *produced, void *context)
+{
+  struct input *input = context;
+
+  *produced = SIZE - input->offset < size ? SIZE - input->offset : size;
+  memcpy(buffer, input->data + input->offset, *produced);
+  input->offset += *produced;
+
+  return 0;
+}
+
+int main(void)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/communicate", NULL };
+  char *data = malloc(SIZE + 1);
+  char *out = NULL;
+  char *err = NULL;
+  int r = -1;
+
+  ASSERT(data);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    data[i] = (char) ('a' + i % 26);
+  }
+
+  data[SIZE] = '\0';
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv,
+                   (reproc_options){
+                       .redirect.err.type = REPROC_REDIRECT_PIPE });
+  ASSERT_OK(r);
+
+  struct input input = { data, 0 };
+  reproc_source in = { source, &input };
+
+  r = reproc_communicate(process, in, reproc_sink_string(&out),
+                         reproc_sink_string(&err));
+  ASSERT_OK(r);
+
+  ASSERT(out != NULL);
+  ASSERT(err != NULL);
+  ASSERT_EQ_STR(out, data);
+  ASSERT_EQ_STR(err, data);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(out);
+  reproc_free(err);
+  out = NULL;
+  err = NULL;
+
+  // The child process exits without reading its input. Writing the input must
+  // fail with `REPROC_EPIPE` instead of raising `SIGPIPE`.
+  const char *exit_argv[] = { RESOURCE_DIRECTORY "/communicate", "exit",
+                              NULL };
+
+  process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, exit_argv, (reproc_options){ 0 });
+  ASSERT_OK(r);
+
+  input.offset = 0;
+
+  r = reproc_communicate(process, in, reproc_sink_string(&out),
+                         REPROC_SINK_NULL);
+  ASSERT_OK(r);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(out);
+  free(data);
+}
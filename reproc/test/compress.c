@@ -0,0 +1,184 @@
+#include <reproc/compress.h>
+#include <reproc/reproc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "assert.h"
+
+// Enough output to fill a bunch of blocks and the queue of the thread.
+enum { SIZE = 1 << 21 };
+
+struct buffer {
+  uint8_t *data;
+  size_t size;
+};
+
+static int output(const uint8_t *data, size_t size, void *context)
+{
+  struct buffer *buffer = context;
+
+  buffer->data = realloc(buffer->data, buffer->size + size);
+  ASSERT(buffer->data);
+
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size += size;
+
+  return 0;
+}
+
+static uint32_t load32(const uint8_t *data)
+{
+  return (uint32_t) data[0] | (uint32_t) data[1] << 8 |
+         (uint32_t) data[2] << 16 | (uint32_t) data[3] << 24;
+}
+
+static size_t length_read(const uint8_t **in, size_t length)
+{
+  if (length == 15) {
+    uint8_t byte = 0;
+
+    do {
+      byte = *(*in)++;
+      length += byte;
+    } while (byte == 255);
+  }
+
+  return length;
+}
+
+// Decodes an LZ4 frame produced by the compressor.
+static struct buffer decompress(struct buffer frame)
+{
+  const uint8_t header[] = { 0x04, 0x22, 0x4D, 0x18, 0x60, 0x40, 0x82 };
+  struct buffer result = { malloc(SIZE * 2), 0 };
+  const uint8_t *in = frame.data + sizeof(header);
+
+  ASSERT(result.data);
+  ASSERT(frame.size >= sizeof(header) + 4);
+  ASSERT_EQ_MEM(frame.data, header, sizeof(header));
+
+  for (;;) {
+    uint32_t size = load32(in);
+    in += 4;
+
+    if (size == 0) {
+      break;
+    }
+
+    if (size & 0x80000000U) {
+      size &= ~0x80000000U;
+      memcpy(result.data + result.size, in, size);
+      result.size += size;
+      in += size;
+      continue;
+    }
+
+    const uint8_t *end = in + size;
+
+    while (in < end) {
+      uint8_t token = *in++;
+      size_t literals = length_read(&in, token >> 4);
+
+      memcpy(result.data + result.size, in, literals);
+      result.size += literals;
+      in += literals;
+
+      if (in == end) {
+        break;
+      }
+
+      size_t offset = (size_t) in[0] | (size_t) in[1] << 8;
+      in += 2;
+
+      size_t match = length_read(&in, token & 0xF) + 4;
+      ASSERT(offset > 0 && offset <= result.size);
+
+      for (size_t i = 0; i < match; i++) {
+        result.data[result.size] = result.data[result.size - offset];
+        result.size++;
+      }
+    }
+  }
+
+  ASSERT(in == frame.data + frame.size);
+
+  return result;
+}
+
+static void roundtrip(const uint8_t *data, bool thread)
+{
+  struct buffer frame = { NULL, 0 };
+  reproc_compress_options options = { .output = { output, &frame },
+                                      .thread = thread };
+
+  reproc_compressor *compressor = reproc_compressor_new(options);
+  if (compressor == NULL && thread) {
+    return; // Built without `REPROC_MULTITHREADED`.
+  }
+
+  ASSERT(compressor);
+
+  reproc_sink sink = reproc_sink_compress(compressor);
+
+  // Chunks of varying sizes that don't line up with the blocks.
+  for (size_t offset = 0, size = 1; offset < SIZE; size = size * 3 % 70001) {
+    size = size < SIZE - offset ? size : SIZE - offset;
+    int r = sink.function(REPROC_STREAM_OUT, data + offset, size,
+                          sink.context);
+    ASSERT_OK(r);
+    offset += size;
+  }
+
+  int r = reproc_compressor_finish(compressor);
+  ASSERT_OK(r);
+
+  r = sink.function(REPROC_STREAM_OUT, data, 1, sink.context);
+  ASSERT_EQ_INT(r, REPROC_EINVAL);
+
+  reproc_compressor_destroy(compressor);
+
+  struct buffer result = decompress(frame);
+  ASSERT_EQ_SIZE(result.size, (size_t) SIZE);
+  ASSERT_EQ_MEM(result.data, data, SIZE);
+
+  free(result.data);
+  free(frame.data);
+}
+
+int main(void)
+{
+  uint8_t *data = malloc(SIZE);
+  ASSERT(data);
+
+  // Repetitive text interleaved with incompressible noise.
+  uint32_t state = 1;
+  for (size_t i = 0; i < SIZE; i++) {
+    state = state * 1103515245 + 12345;
+    data[i] = (i / 100000) % 2 ? (uint8_t) (state >> 16)
+                               : (uint8_t) ("reproc "[i % 7]);
+  }
+
+  roundtrip(data, false);
+  roundtrip(data, true);
+
+  // An empty frame.
+  struct buffer frame = { NULL, 0 };
+  reproc_compress_options options = { .output = { output, &frame } };
+  reproc_compressor *compressor = reproc_compressor_new(options);
+  ASSERT(compressor);
+  ASSERT_OK(reproc_compressor_finish(compressor));
+  reproc_compressor_destroy(compressor);
+
+  struct buffer result = decompress(frame);
+  ASSERT_EQ_SIZE(result.size, (size_t) 0);
+
+  free(result.data);
+  free(frame.data);
+
+  // Exactly one of `output` and `file` has to be set.
+  options.file = stdout;
+  ASSERT(reproc_compressor_new(options) == NULL);
+
+  free(data);
+}
@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <reproc/reproc.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#include "assert.h"
+
+#define MESSAGE "status: ok\n"
+
+int main(void)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/extra-fds", NULL };
+  uint8_t buffer[64];
+  size_t size = 0;
+  int fds[2] = { -1, -1 };
+  int r = -1;
+
+  r = pipe(fds);
+  ASSERT_OK(r);
+
+  reproc_options options = { 0 };
+  options.extra_fds[0].fd = 3;
+  options.extra_fds[1].fd = 4;
+  options.extra_fds[1].input = true;
+  options.extra_fds[2].fd = 5;
+  options.extra_fds[2].handle = fds[1];
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  close(fds[1]);
+
+  reproc_event_source source = { process, REPROC_EVENT_EXTRA << 1, 0 };
+  r = reproc_poll(&source, 1, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 1);
+  ASSERT_EQ_INT(source.events, REPROC_EVENT_EXTRA << 1);
+
+  r = reproc_write_extra(process, 1, (const uint8_t *) MESSAGE,
+                         strlen(MESSAGE));
+  ASSERT_EQ_INT(r, (int) strlen(MESSAGE));
+
+  r = reproc_close_extra(process, 1);
+  ASSERT_OK(r);
+
+  for (;;) {
+    source = (reproc_event_source){ process, REPROC_EVENT_EXTRA, 0 };
+    r = reproc_poll(&source, 1, REPROC_INFINITE);
+    if (r == REPROC_EPIPE) {
+      break;
+    }
+
+    ASSERT_EQ_INT(r, 1);
+    ASSERT_EQ_INT(source.events, REPROC_EVENT_EXTRA);
+
+    r = reproc_read_extra(process, 0, buffer + size, sizeof(buffer) - size);
+    if (r == REPROC_EPIPE) {
+      break;
+    }
+
+    ASSERT(r > 0);
+    size += (size_t) r;
+  }
+
+  ASSERT_EQ_SIZE(size, strlen(MESSAGE));
+  ASSERT_EQ_MEM(buffer, MESSAGE, size);
+
+  // The handle passed as fd 5 received the same data.
+  ASSERT_EQ_INT((int) read(fds[0], buffer, sizeof(buffer)),
+                (int) strlen(MESSAGE));
+  ASSERT_EQ_MEM(buffer, MESSAGE, strlen(MESSAGE));
+  close(fds[0]);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+
+  // Extra file descriptors may not replace the standard streams.
+  options = (reproc_options){ 0 };
+  options.extra_fds[0].fd = 1;
+
+  process = reproc_new();
+  ASSERT(process);
+  ASSERT_EQ_INT(reproc_start(process, argv, options), REPROC_EINVAL);
+  reproc_destroy(process);
+}
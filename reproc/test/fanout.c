@@ -0,0 +1,75 @@
+#include <reproc/run.h>
+
+#include <string.h>
+
+#include "assert.h"
+
+#define SOURCE "seq 1 300000"
+
+static reproc_t *start(const char *command, reproc_options options)
+{
+  const char *argv[] = { "sh", "-c", command, NULL };
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  int r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  return process;
+}
+
+static void finish(reproc_t *process, const char *expected)
+{
+  char *output = NULL;
+
+  int r = reproc_drain(process, reproc_sink_string(&output), REPROC_SINK_NULL);
+  ASSERT_OK(r);
+
+  if (expected != NULL) {
+    ASSERT(output != NULL);
+    ASSERT_EQ_STR(output, expected);
+  }
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(output);
+}
+
+int main(void)
+{
+  const char *argv[] = { "sh", "-c", SOURCE " | cksum", NULL };
+  char *expected = NULL;
+  reproc_sink sink = reproc_sink_string(&expected);
+
+  int r = reproc_run_ex(argv, (reproc_options){ 0 }, sink, REPROC_SINK_NULL);
+  ASSERT_EQ_INT(r, 0);
+  ASSERT(expected != NULL);
+
+  reproc_options options = { 0 };
+  // `tee` only works between pipes so this target gets a copy instead.
+  reproc_options socket = { .redirect.in.type = REPROC_REDIRECT_SOCKET };
+
+  // The `head` target stops reading early. Neither it exiting nor the
+  // `SIGPIPE` that would raise should take the other targets down with it.
+  reproc_t *source = start(SOURCE, options);
+  reproc_t *targets[] = { start("cksum", options),
+                          start("sleep 0.1; cksum", options),
+                          start("head -c 10 > /dev/null", options),
+                          start("cksum", socket), start("cksum", options) };
+  size_t num_targets = sizeof(targets) / sizeof(targets[0]);
+
+  r = reproc_fanout(source, REPROC_STREAM_OUT, targets, num_targets, 4096);
+  ASSERT_OK(r);
+
+  finish(source, NULL);
+  finish(targets[0], expected);
+  finish(targets[1], expected);
+  finish(targets[2], NULL);
+  finish(targets[3], expected);
+  finish(targets[4], expected);
+
+  reproc_free(expected);
+}
@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <reproc/run.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "assert.h"
+
+// Bigger than the stdin pipe so the input has to be streamed in pieces.
+enum { SIZE = 1 << 20 };
+
+static void run(reproc_options options, const char *expected, size_t size)
+{
+  const char *argv[] = { "cat", NULL };
+  char *output = NULL;
+  reproc_sink sink = reproc_sink_string(&output);
+
+  int r = reproc_run_ex(argv, options, sink, REPROC_SINK_NULL);
+  ASSERT_EQ_INT(r, 0);
+  ASSERT(output != NULL);
+
+  ASSERT_EQ_SIZE(strlen(output), size);
+  ASSERT_EQ_MEM(output, expected, size);
+
+  reproc_free(output);
+}
+
+int main(void)
+{
+  char path[] = "/tmp/reproc-input-file-XXXXXX";
+  char *data = malloc(SIZE);
+  ASSERT(data);
+  int r = -1;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    data[i] = (char) ('a' + i % 26);
+  }
+
+  int fd = mkstemp(path);
+  ASSERT(fd >= 0);
+  ASSERT(write(fd, data, SIZE) == (ssize_t) SIZE);
+
+  reproc_options options = { 0 };
+
+  // Input in memory that doesn't fit in the stdin pipe.
+  options.input.data = (const uint8_t *) data;
+  options.input.size = SIZE;
+  run(options, data, SIZE);
+
+  // The same input passed as a sealed anonymous file.
+  options.input.memfd = true;
+  run(options, data, SIZE);
+
+  options.input.data = NULL;
+  options.input.size = 0;
+  options.input.memfd = false;
+
+#if defined(__linux__)
+  // Every child process gets its own position in a shared anonymous file.
+  int memfd = -1;
+  char memfd_path[64];
+
+  r = reproc_memfd((const uint8_t *) data, SIZE, &memfd);
+  ASSERT_OK(r);
+
+  snprintf(memfd_path, sizeof(memfd_path), "/proc/self/fd/%d", memfd);
+  options.input.file.path = memfd_path;
+  run(options, data, SIZE);
+  run(options, data, SIZE);
+
+  options.input.file.path = NULL;
+  close(memfd);
+#endif
+
+  // Handed to the child process directly.
+  options.input.file.path = path;
+  options.input.file.offset = 3;
+  run(options, data + 3, SIZE - 3);
+
+  // Streamed to the child process.
+  options.input.file.path = NULL;
+  options.input.file.handle = fd;
+  options.input.file.offset = 5;
+  options.input.file.length = SIZE - 10;
+  run(options, data + 5, SIZE - 10);
+
+  // A child process that exits without reading all of the input doesn't raise
+  // `SIGPIPE` in the parent.
+  const char *head[] = { "head", "-c1", NULL };
+  options.input.file.handle = 0;
+  options.input.file.offset = 0;
+  options.input.file.length = 0;
+  options.input.data = (const uint8_t *) data;
+  options.input.size = SIZE;
+  r = reproc_run_ex(head, options, REPROC_SINK_NULL, REPROC_SINK_NULL);
+  ASSERT_EQ_INT(r, 0);
+
+  options.input.data = NULL;
+  options.input.size = 0;
+
+  // Only one of `handle` and `path` may be set.
+  const char *argv[] = { "cat", NULL };
+  options.input.file.path = path;
+  ASSERT_EQ_INT(reproc_run(argv, options), REPROC_EINVAL);
+
+  close(fd);
+  unlink(path);
+  free(data);
+}
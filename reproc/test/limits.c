@@ -0,0 +1,52 @@
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+static void run(reproc_options options, const char *expected)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/limits", NULL };
+  char *output = NULL;
+  reproc_sink sink = reproc_sink_string(&output);
+  int r = -1;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  r = reproc_drain(process, sink, REPROC_SINK_NULL);
+  ASSERT_OK(r);
+  ASSERT(output != NULL);
+
+  ASSERT_EQ_STR(output, expected);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(output);
+}
+
+int main(void)
+{
+  reproc_options options = { 0 };
+
+  options.limits.nofile = (reproc_limit){ .set = true, .soft = 32, .hard = 64 };
+  options.limits.core = (reproc_limit){ .set = true, .soft = 0, .hard = 0 };
+  run(options, "32 64 0");
+
+  // The soft limit can't exceed the hard limit.
+  options.limits.core = (reproc_limit){ .set = true, .soft = 1, .hard = 0 };
+
+  const char *argv[] = { RESOURCE_DIRECTORY "/limits", NULL };
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  int r = reproc_start(process, argv, options);
+  ASSERT(r == REPROC_EINVAL);
+
+  reproc_destroy(process);
+}
@@ -0,0 +1,64 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <reproc/run.h>
+
+#include "assert.h"
+
+int main(void)
+{
+  char dir[] = "/tmp/reproc-path-cache-XXXXXX";
+  char program[sizeof(dir) + sizeof("/path-cache")];
+  char path[sizeof(dir) + sizeof("PATH=/non-existing:")];
+  int r = -1;
+
+  ASSERT(mkdtemp(dir) != NULL);
+
+  snprintf(program, sizeof(program), "%s/path-cache", dir);
+  r = symlink(RESOURCE_DIRECTORY "/path-cache", program);
+  ASSERT(r == 0);
+
+  // Directories modified less than a second ago aren't cached so we backdate
+  // the directory we just added the program to.
+  time_t past = time(NULL) - 60;
+  struct timespec times[] = { { .tv_sec = past }, { .tv_sec = past } };
+  r = utimensat(AT_FDCWD, dir, times, 0);
+  ASSERT(r == 0);
+
+  snprintf(path, sizeof(path), "PATH=/non-existing:%s", dir);
+
+  const char *argv[] = { "path-cache", NULL };
+  const char *envp[] = { path, NULL };
+  reproc_options options = { .env.behavior = REPROC_ENV_EMPTY,
+                             .env.extra = envp };
+
+  for (size_t i = 0; i < 3; i++) {
+    r = reproc_run(argv, options);
+    ASSERT_OK(r);
+    ASSERT_EQ_INT(r, 0);
+  }
+
+  // The first run searches PATH and caches the result which the other runs
+  // use.
+  reproc_cache_stats stats = reproc_path_cache_stats();
+  ASSERT_EQ_SIZE(stats.misses, (size_t) 1);
+  ASSERT_EQ_SIZE(stats.hits, (size_t) 2);
+
+  options.path_cache.disable = true;
+
+  r = reproc_run(argv, options);
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+
+  stats = reproc_path_cache_stats();
+  ASSERT_EQ_SIZE(stats.hits + stats.misses, (size_t) 3);
+
+  ASSERT(unlink(program) == 0);
+  ASSERT(rmdir(dir) == 0);
+}
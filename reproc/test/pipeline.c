@@ -0,0 +1,69 @@
+#include <reproc/drain.h>
+#include <reproc/pipeline.h>
+
+#include "assert.h"
+
+enum { SIZE = 3 };
+
+static void pipeline(const char *const *argv[SIZE],
+                     const char *expected,
+                     int status,
+                     bool discard)
+{
+  reproc_t *processes[SIZE] = { NULL };
+  reproc_options options[SIZE] = { { 0 } };
+  char *output = NULL;
+  int r = -1;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    processes[i] = reproc_new();
+    ASSERT(processes[i]);
+  }
+
+  for (size_t i = 0; i < SIZE - 1; i++) {
+    options[i].redirect.discard = discard;
+  }
+
+  options[SIZE - 1].redirect.err.type = REPROC_REDIRECT_DISCARD;
+
+  r = reproc_pipeline_start(processes, argv, options, SIZE);
+  ASSERT_OK(r);
+
+  r = reproc_drain(processes[SIZE - 1], reproc_sink_string(&output),
+                   REPROC_SINK_NULL);
+  ASSERT_OK(r);
+  ASSERT(output != NULL);
+  ASSERT_EQ_STR(output, expected);
+
+  r = reproc_pipeline_wait(processes, SIZE, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, status);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    reproc_destroy(processes[i]);
+  }
+
+  reproc_free(output);
+}
+
+int main(void)
+{
+  const char *produce[] = { "sh", "-c", "printf 'b\\na\\nc\\n'", NULL };
+  const char *sort[] = { "sort", NULL };
+  const char *upper[] = { "tr", "a-z", "A-Z", NULL };
+  const char *const *sorted[SIZE] = { produce, sort, upper };
+  pipeline(sorted, "A\nB\nC\n", 0, false);
+
+  // The exit status of the last process that failed is reported.
+  const char *fail[] = { "sh", "-c", "echo x; exit 3", NULL };
+  const char *cat[] = { "cat", NULL };
+  const char *pass[] = { "sh", "-c", "cat; exit 0", NULL };
+  const char *const *failed[SIZE] = { fail, cat, pass };
+  pipeline(failed, "x\n", 3, false);
+
+  // `discard` applies to the stderr of the processes in the middle of the
+  // pipeline without touching the pipes between them.
+  const char *noisy[] = { "sh", "-c", "head -c 1048576 /dev/zero >&2; cat",
+                          NULL };
+  const char *const *discarded[SIZE] = { produce, noisy, upper };
+  pipeline(discarded, "B\nA\nC\n", 0, true);
+}
@@ -0,0 +1,130 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+// The background `sleep` inherits stdout and keeps it open after the shell
+// exits.
+static reproc_t *start(void)
+{
+  const char *argv[] = { "sh", "-c", "sleep 10 & echo started", NULL };
+  reproc_options options = { 0 };
+  options.session = true;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  int r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  return process;
+}
+
+// The killed `sleep` is reparented so it might take a while before it's
+// reaped and leaves the process group.
+static void assert_killed(int pgid)
+{
+  struct timespec delay = { .tv_nsec = 10 * 1000 * 1000 };
+  int r = -1;
+
+  for (int i = 0; i < 500; i++) {
+    r = kill(-pgid, 0);
+    if (r < 0) {
+      break;
+    }
+
+    nanosleep(&delay, NULL);
+  }
+
+  ASSERT(r < 0 && errno == ESRCH);
+}
+
+static void test_kill(void)
+{
+  char *output = NULL;
+  reproc_sink sink = reproc_sink_string(&output);
+  int r = -1;
+
+  reproc_t *process = start();
+
+  int pgid = reproc_pid(process);
+  ASSERT_OK(pgid);
+
+#if defined(__linux__)
+  r = reproc_drain(process, sink, REPROC_SINK_NULL);
+  ASSERT_OK(r);
+  ASSERT(output != NULL);
+
+  ASSERT_EQ_STR(output, "started\n");
+#else
+  // `reproc_drain` would wait for `sleep` to close stdout.
+  (void) sink;
+#endif
+
+  // Unless it already was, the shell is only reaped by `reproc_wait` so the
+  // process group is still ours. `sleep` is still part of it so there's
+  // something to kill.
+  r = reproc_kill(process);
+  ASSERT_OK(r);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_OK(r);
+#if defined(__linux__)
+  ASSERT_EQ_INT(r, 0);
+#endif
+
+  assert_killed(pgid);
+
+  // Once the shell is reaped, its process group ID might be reused so nothing
+  // is signaled anymore.
+  r = reproc_kill(process);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(output);
+}
+
+static void test_stop(void)
+{
+  reproc_stop_actions stop = {
+    { REPROC_STOP_WAIT, 1000 },
+    { REPROC_STOP_KILL, REPROC_INFINITE },
+    { REPROC_STOP_NOOP, 0 },
+  };
+  char buffer[16] = { 0 };
+  int r = -1;
+
+  reproc_t *process = start();
+
+  int pgid = reproc_pid(process);
+  ASSERT_OK(pgid);
+
+  r = reproc_read(process, REPROC_STREAM_OUT, (uint8_t *) buffer,
+                  sizeof(buffer) - 1);
+  ASSERT_OK(r);
+
+  ASSERT_EQ_STR(buffer, "started\n");
+
+  // On Linux, the shell exits during `REPROC_STOP_WAIT` and `sleep` is killed
+  // before the shell is reaped. Elsewhere, `sleep` keeps the exit pipe open so
+  // `REPROC_STOP_WAIT` times out and `REPROC_STOP_KILL` kills the group.
+  r = reproc_stop(process, stop);
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+
+  assert_killed(pgid);
+
+  reproc_destroy(process);
+}
+
+int main(void)
+{
+  test_kill();
+  test_stop();
+}
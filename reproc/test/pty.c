@@ -0,0 +1,45 @@
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+#include <reproc/run.h>
+
+#include "assert.h"
+
+static void
+run(const char *script, reproc_options options, const char *expected)
+{
+  const char *argv[] = { "sh", "-c", script, NULL };
+  char *output = NULL;
+
+  int r = reproc_run_ex(argv, options, reproc_sink_string(&output),
+                        REPROC_SINK_NULL);
+  ASSERT_EQ_INT(r, 0);
+  ASSERT(output != NULL);
+  ASSERT_EQ_STR(output, expected);
+
+  reproc_free(output);
+}
+
+int main(void)
+{
+  reproc_options options = { 0 };
+
+  // stdout is a terminal that doesn't translate newlines.
+  options.redirect.out.type = REPROC_REDIRECT_PTY;
+  run("test -t 1 && echo tty; test -t 2 || echo pipe", options, "tty\npipe\n");
+
+  // stdout and stderr share a single terminal.
+  options.redirect.err.type = REPROC_REDIRECT_PTY;
+  run("echo out; echo err >&2", options, "out\nerr\n");
+
+  // The terminal is the controlling terminal of the child process.
+  options.redirect.out.pty.rows = 30;
+  options.redirect.out.pty.columns = 100;
+  options.redirect.out.pty.controlling = true;
+  options.redirect.err = options.redirect.out;
+  run("stty size < /dev/tty", options, "30 100\n");
+
+  // stdin can't be redirected to a terminal.
+  const char *argv[] = { "true", NULL };
+  options.redirect.in.type = REPROC_REDIRECT_PTY;
+  ASSERT_EQ_INT(reproc_run(argv, options), REPROC_EINVAL);
+}
@@ -0,0 +1,67 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+static reproc_t *start(const char *script, reproc_stop_actions stop)
+{
+  const char *argv[] = { "sh", "-c", script, NULL };
+  reproc_options options = { .stop = stop };
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  int r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  return process;
+}
+
+// A process that has been reaped doesn't exist anymore, not even as a zombie.
+static void assert_reaped(int pid)
+{
+  ASSERT(kill(pid, 0) < 0 && errno == ESRCH);
+}
+
+int main(void)
+{
+  int r = reproc_reaper_start(false);
+  ASSERT_OK(r);
+
+  reproc_t *process = start("exit 3", (reproc_stop_actions){ 0 });
+  int pid = reproc_pid(process);
+  ASSERT_OK(pid);
+
+  while ((r = reproc_reap(REPROC_INFINITE)) == 0) {}
+  ASSERT_EQ_INT(r, 1);
+  assert_reaped(pid);
+
+  // The pid might already belong to another process so it isn't signaled.
+  r = reproc_kill(process);
+  ASSERT_EQ_INT(r, 0);
+
+  // The exit status is kept until `reproc_wait` picks it up.
+  r = reproc_wait(process, 0);
+  ASSERT_EQ_INT(r, 3);
+
+  reproc_destroy(process);
+
+  // Destroy the process without waiting for it to exit.
+  reproc_stop_actions stop = { .first = { REPROC_STOP_WAIT, 0 } };
+  process = start("sleep 0.1", stop);
+  pid = reproc_pid(process);
+  ASSERT_OK(pid);
+
+  reproc_destroy(process);
+
+  while ((r = reproc_reap(REPROC_INFINITE)) == 0) {}
+  ASSERT_EQ_INT(r, 1);
+  assert_reaped(pid);
+
+  r = reproc_reaper_stop();
+  ASSERT_OK(r);
+}
@@ -0,0 +1,47 @@
+#include <reproc/ring.h>
+
+#include "assert.h"
+
+// Far more data than fits in the ring so the child process has to wait for us.
+#define RECORDS "100000"
+
+int main(void)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/ring", RECORDS, NULL };
+  const uint8_t *data = NULL;
+  size_t size = 0;
+  int records = 0;
+  int r = -1;
+
+  reproc_options options = { 0 };
+  options.ring.size = 4096;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  reproc_event_source source = { process, REPROC_EVENT_RING, 0 };
+  r = reproc_poll(&source, 1, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 1);
+  ASSERT_EQ_INT(source.events, REPROC_EVENT_RING);
+
+  while ((r = reproc_ring_read(process, &data, &size)) == 0) {
+    ASSERT_EQ_SIZE(size, (size_t) records % 301);
+
+    for (size_t i = 0; i < size; i++) {
+      ASSERT_EQ_INT(data[i], (uint8_t) records);
+    }
+
+    records++;
+  }
+
+  ASSERT_EQ_INT(r, REPROC_EPIPE);
+  ASSERT_EQ_INT(records, 100000);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+}
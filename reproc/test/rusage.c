@@ -0,0 +1,32 @@
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+int main(void)
+{
+  const char *argv[] = { RESOURCE_DIRECTORY "/rusage", NULL };
+  reproc_usage usage = { 0 };
+  int r = -1;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, (reproc_options){ 0 });
+  ASSERT_OK(r);
+
+  // Usage is only available once the child process has exited.
+  r = reproc_rusage(process, &usage);
+  ASSERT(r == REPROC_EINVAL);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+
+  r = reproc_rusage(process, &usage);
+  ASSERT_OK(r);
+
+  ASSERT(usage.utime + usage.stime > 0);
+  ASSERT(usage.maxrss >= 64 * 1024 * 1024);
+
+  reproc_destroy(process);
+}
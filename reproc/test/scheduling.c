@@ -0,0 +1,74 @@
+#if defined(__linux__)
+  #define _GNU_SOURCE
+  #include <sched.h>
+#endif
+
+#include <reproc/run.h>
+
+#include <stdio.h>
+
+#include "assert.h"
+
+int main(void)
+{
+  reproc_options options = { 0 };
+  options.scheduling.nice.set = true;
+  options.scheduling.nice.value = 5;
+
+#if defined(__linux__)
+  const char *argv[] = { "sh", "-c",
+                         "nice && grep Cpus_allowed_list /proc/self/status",
+                         NULL };
+  // Pin the child process to the last CPU we're allowed to run on. CPU 0 isn't
+  // necessarily one of them.
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  ASSERT(sched_getaffinity(0, sizeof(set), &set) == 0);
+
+  int cpus[] = { -1 };
+  for (size_t i = 0; i < CPU_SETSIZE; i++) {
+    if (CPU_ISSET(i, &set)) {
+      cpus[0] = (int) i;
+    }
+  }
+
+  ASSERT(cpus[0] >= 0);
+
+  char expected[64];
+  snprintf(expected, sizeof(expected), "5\nCpus_allowed_list:\t%d\n", cpus[0]);
+
+  options.scheduling.affinity.cpus = cpus;
+  options.scheduling.affinity.size = 1;
+  options.scheduling.cpu.policy = REPROC_SCHED_BATCH;
+  options.scheduling.io.type = REPROC_IOPRIO_BEST_EFFORT;
+  options.scheduling.io.level = 7;
+#else
+  const char *argv[] = { "nice", NULL };
+  const char *expected = "5\n";
+#endif
+
+  char *output = NULL;
+  reproc_sink sink = reproc_sink_string(&output);
+
+  int r = reproc_run_ex(argv, options, sink, REPROC_SINK_NULL);
+  ASSERT_OK(r);
+  ASSERT_EQ_INT(r, 0);
+  ASSERT(output != NULL);
+
+  ASSERT_EQ_STR(output, expected);
+
+  reproc_free(output);
+
+  // Nice values are between -20 and 19.
+  options.scheduling.nice.value = 20;
+
+  r = reproc_run(argv, options);
+  ASSERT(r == REPROC_EINVAL);
+
+  // Out of range policies are rejected instead of indexing out of bounds.
+  options.scheduling.nice.value = 5;
+  options.scheduling.cpu.policy = (REPROC_SCHED) 100;
+
+  r = reproc_run(argv, options);
+  ASSERT(r == REPROC_EINVAL);
+}
@@ -0,0 +1,71 @@
+#include <reproc/drain.h>
+
+#include <string.h>
+
+#include "assert.h"
+
+#define MESSAGE "reproc stands for REdirected PROCess"
+
+static bool is_err(REPROC_STREAM stream,
+                   const uint8_t *buffer,
+                   size_t size,
+                   void *context)
+{
+  (void) buffer;
+  (void) size;
+  (void) context;
+
+  return stream == REPROC_STREAM_ERR;
+}
+
+static int count(REPROC_STREAM stream,
+                 const uint8_t *buffer,
+                 size_t size,
+                 void *context)
+{
+  (void) stream;
+  (void) buffer;
+  (void) size;
+
+  (*(int *) context)++;
+
+  return 0;
+}
+
+static void feed(reproc_sink sink, REPROC_STREAM stream, size_t size)
+{
+  int r = sink.function(stream, (const uint8_t *) MESSAGE, size, sink.context);
+  ASSERT_OK(r);
+}
+
+int main(void)
+{
+  char *limited = NULL;
+  char *filtered = NULL;
+  int calls = 0;
+
+  reproc_limiter limiter = { 10, reproc_sink_string(&limited), 0 };
+  reproc_filter filter = { is_err, NULL, reproc_sink_string(&filtered) };
+  reproc_sampler sampler = { 2, { count, &calls }, 0 };
+
+  // Combinators nest: the tee forwards to the three other combinators.
+  reproc_sink sinks[] = { reproc_sink_limit(&limiter),
+                          reproc_sink_filter(&filter),
+                          reproc_sink_sample(&sampler) };
+  reproc_tee tee = { sinks, 3 };
+  reproc_sink sink = reproc_sink_tee(&tee);
+
+  feed(sink, REPROC_STREAM_IN, 0);
+  feed(sink, REPROC_STREAM_OUT, 6);
+  feed(sink, REPROC_STREAM_ERR, 6);
+  feed(sink, REPROC_STREAM_ERR, strlen(MESSAGE));
+  feed(sink, REPROC_STREAM_OUT, 0);
+
+  ASSERT_EQ_STR(limited, "reprocrepr");
+  ASSERT_EQ_STR(filtered, "reproc" MESSAGE);
+  // Both empty calls and the first and third chunk.
+  ASSERT_EQ_INT(calls, 4);
+
+  reproc_free(limited);
+  reproc_free(filtered);
+}
@@ -0,0 +1,137 @@
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "assert.h"
+
+// Much bigger than the socket buffers so writing stdin and reading stdout have
+// to be interleaved.
+enum { SIZE = 1 << 20 };
+
+struct input {
+  const char *data;
+  size_t offset;
+};
+
+static int source(uint8_t *buffer, size_t size, size_t *produced, void *context)
+{
+  struct input *input = context;
+
+  *produced = SIZE - input->offset < size ? SIZE - input->offset : size;
+  memcpy(buffer, input->data + input->offset, *produced);
+  input->offset += *produced;
+
+  return 0;
+}
+
+static void stream(void)
+{
+  const char *argv[] = { "cat", NULL };
+  char *data = malloc(SIZE + 1);
+  char *out = NULL;
+  int r = -1;
+
+  ASSERT(data);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    data[i] = (char) ('a' + i % 26);
+  }
+
+  data[SIZE] = '\0';
+
+  reproc_redirect redirect = { .socket.buffer = 4096 };
+  reproc_options options = { .redirect = { .in = redirect,
+                                           .out = redirect,
+                                           .err.type =
+                                               REPROC_REDIRECT_DISCARD } };
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  struct input input = { data, 0 };
+  reproc_source in = { source, &input };
+
+  // Closing stdin has to shut down the shared socket or `cat` never exits.
+  r = reproc_communicate(process, in, reproc_sink_string(&out),
+                         REPROC_SINK_NULL);
+  ASSERT_OK(r);
+
+  ASSERT(out != NULL);
+  ASSERT_EQ_STR(out, data);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+  reproc_free(out);
+  free(data);
+}
+
+#if defined(__linux__)
+static void seqpacket(void)
+{
+  const char *argv[] = { "cat", NULL };
+  const char *messages[] = { "ab", "cde" };
+  uint8_t buffer[64];
+  int r = -1;
+
+  reproc_redirect redirect = { .socket.seqpacket = true };
+  reproc_options options = { .redirect = { .in = redirect,
+                                           .out = redirect,
+                                           .err.type =
+                                               REPROC_REDIRECT_DISCARD } };
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  for (size_t i = 0; i < 2; i++) {
+    r = reproc_write(process, (const uint8_t *) messages[i],
+                     strlen(messages[i]));
+    ASSERT_EQ_INT(r, (int) strlen(messages[i]));
+
+    // Every read returns exactly one message.
+    r = reproc_read(process, REPROC_STREAM_OUT, buffer, sizeof(buffer));
+    ASSERT_EQ_INT(r, (int) strlen(messages[i]));
+    ASSERT_EQ_MEM(buffer, messages[i], strlen(messages[i]));
+  }
+
+  r = reproc_close(process, REPROC_STREAM_IN);
+  ASSERT_OK(r);
+
+  r = reproc_read(process, REPROC_STREAM_OUT, buffer, sizeof(buffer));
+  ASSERT_EQ_INT(r, REPROC_EPIPE);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_EQ_INT(r, 0);
+
+  reproc_destroy(process);
+}
+#endif
+
+int main(void)
+{
+  stream();
+
+#if defined(__linux__)
+  seqpacket();
+#endif
+
+  // Socket options require a socket.
+  const char *argv[] = { "cat", NULL };
+  reproc_options options = { 0 };
+  options.redirect.out.type = REPROC_REDIRECT_PIPE;
+  options.redirect.out.socket.seqpacket = true;
+
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+  ASSERT_EQ_INT(reproc_start(process, argv, options), REPROC_EINVAL);
+  reproc_destroy(process);
+}
@@ -0,0 +1,77 @@
+#include "../resources/sleep.h"
+
+#include <reproc/drain.h>
+#include <reproc/reproc.h>
+
+#include "assert.h"
+
+enum { CHUNKS = 256, CHUNK_SIZE = 4096 };
+
+typedef struct {
+  size_t size[3];
+  int64_t last;
+  // Amount of stdout output received when the first stderr output arrived.
+  size_t before_err;
+} context;
+
+static int sink(REPROC_STREAM stream,
+                const uint8_t *buffer,
+                size_t size,
+                int64_t timestamp,
+                void *ctx)
+{
+  (void) buffer;
+
+  context *c = (context *) ctx;
+
+  ASSERT(timestamp >= c->last);
+  ASSERT(timestamp <= reproc_now());
+
+  if (stream == REPROC_STREAM_ERR && size > 0 && c->size[stream] == 0) {
+    c->before_err = c->size[REPROC_STREAM_OUT];
+  }
+
+  c->size[stream] += size;
+  c->last = timestamp;
+
+  // Give the child process time to fill the stdout pipe again so stdout is
+  // always ready and a reader that prefers stdout never gets to stderr.
+  if (stream == REPROC_STREAM_OUT && size > 0) {
+    millisleep(1);
+  }
+
+  return 0;
+}
+
+int main(void)
+{
+  reproc_t *process = reproc_new();
+  ASSERT(process);
+
+  const char *argv[] = { RESOURCE_DIRECTORY "/timed", NULL };
+
+  reproc_options options = { 0 };
+  options.redirect.err.type = REPROC_REDIRECT_PIPE;
+
+  int r = reproc_start(process, argv, options);
+  ASSERT_OK(r);
+
+  context c = { { 0 }, reproc_now(), 0 };
+  reproc_timed_sink timed = { sink, &c };
+
+  r = reproc_drain(process, reproc_sink_timed(&timed),
+                   reproc_sink_timed(&timed));
+  ASSERT_OK(r);
+
+  ASSERT_EQ_SIZE(c.size[REPROC_STREAM_OUT], (size_t) CHUNKS * CHUNK_SIZE);
+  ASSERT_EQ_SIZE(c.size[REPROC_STREAM_ERR], (size_t) CHUNKS * CHUNK_SIZE);
+
+  // stderr has to be read while stdout is still busy instead of after it's
+  // done.
+  ASSERT(c.before_err < (size_t) CHUNKS * CHUNK_SIZE);
+
+  r = reproc_wait(process, REPROC_INFINITE);
+  ASSERT_OK(r);
+
+  reproc_destroy(process);
+}